@@ -7,6 +7,8 @@
 #include <limits.h>
 #ifdef TGUY_USE_UTF8PROC
 #include <utf8proc.h>
+#elif defined TGUY_USE_LIBGRAPHEME
+#include <grapheme.h>
 #elif defined TGUY_USE_WGRAPHEME
 #include <wgrapheme.h>
 #else
@@ -85,6 +87,18 @@ static void strvarr_copy(TGStrView *dst, const TGStrView *src, size_t len) {
     for (size_t i = 0; i < len; i++) dst[i] = src[i];
 }
 
+/**
+ * Elements and sprites of TrashGuyState transcoded to utf-16 or utf-32, so frames are rendered by plain copies
+ */
+typedef struct {
+    size_t buf_size; /**< same as TrashGuyState::buf_size, but in code units */
+    size_t *ends; /**< end offsets in code units of text elements followed by right, left, can and space sprites */
+    unsigned char *units; /**< all the strings, one after another, in native byte order */
+} TGuyWideCache;
+
+/** Index of TGuyWideCache::ends after the text elements for sprite */
+enum { TGUY_WIDE_RIGHT, TGUY_WIDE_LEFT, TGUY_WIDE_CAN, TGUY_WIDE_SPACE, TGUY_WIDE_SPRITES };
+
 /**
  * Struct to keep relevant TrashGuy data
  */
@@ -98,9 +112,9 @@ struct TrashGuyState {
               sprite_space; /**< empty space sprite */
     TGStrViewArr text; /**< elements for TrashGuy to process, each one can contain one or more characters */
     TGStrViewArr arena; /**< array where we place current element */
-#ifdef TGUY_FASTCLEAR
-    TGStrViewArr empty_arena_; /**< arena, but filled with only trash can and space sprites */
-#endif
+    TGStrView *empty_arena_; /**< arena, but filled with only trash can and space sprites,
+                              * allocated separately in TGUY_CLEAR_SHADOW mode only, NULL otherwise */
+    TGuyClearMode clear_mode_; /**< how tguy_clear_field() fills the arena, see tguy_set_clear_mode() */
     unsigned cur_frame; /**< current frame set, initially UINT_MAX */
     unsigned max_frames; /**< number of frames animation takes to complete -> 0 <= frame < max_frames */
     unsigned pos;
@@ -108,7 +122,20 @@ struct TrashGuyState {
     unsigned element_index;
     unsigned next_element_index;
     size_t buf_size; /**< computed size of the buffer to store one frame as string representation */
+    size_t cell_size; /**< computed size of the largest arena cell, 0 if not computed yet */
     char *output_str; /**< optional pointer to output string is stored here */
+    size_t grid_cell; /**< if every element and space sprite has the same size in bytes and both TrashGuy sprites
+                       * have the same size too, every frame is a grid of equal cells, it's size of the cell then,
+                       * otherwise 0. In grid mode output_str is patched in place by sequential tguy_set_frame() */
+    int grid_valid; /**< whether output_str holds the currently set frame, only used in grid mode */
+    void *owned_mem_; /**< memory strings are borrowed from which is freed together with the state, NULL if none */
+    const char *lazy_src_; /**< text segmented on demand, NULL if state isn't lazy. In lazy mode text and arena
+                            * are allocated separately and last element of text is the unsegmented rest of lazy_src_ */
+    size_t lazy_len_; /**< number of bytes in lazy_src_ */
+    size_t lazy_seg_; /**< number of bytes of lazy_src_ already split into elements */
+    size_t lazy_cap_; /**< capacity of text array in lazy mode, arena is larger by the same amount as usual */
+    TGuyWideCache *utf16_; /**< created by first tguy_get_bsize_utf16() or tguy_sprint_utf16(), NULL until then */
+    TGuyWideCache *utf32_; /**< created by first tguy_get_bsize_utf32() or tguy_sprint_utf32(), NULL until then */
     TGStrView views_mem[]; /**< array of allocated views which are later distributed among fields */
 };
 
@@ -129,6 +156,9 @@ static inline unsigned get_first_frame_for_element(unsigned first_element_frames
     return element_index * (element_index + first_element_frames_count - 1); /* todo: math overflow checks? */
 }
 
+/** Arenas with fewer cells to clear than this are cleared in a loop by TGUY_CLEAR_AUTO, larger ones are filled */
+#define TGUY_CLEAR_LOOP_MAX 64
+
 /**
  *  Replaces TrashGuyState::arena[1:n+1] with with TrashGuyState::sprite_space
  * @param st                Valid TrashGuyState
@@ -138,39 +168,57 @@ static inline void tguy_clear_field(const TrashGuyState *st, unsigned n_clear_el
     TGStrViewArr arena = st->arena;
     TGStrViewArr text = st->text;
     size_t items_offset = arena.len - text.len + n_clear_elements;
-#ifdef TGUY_FASTCLEAR
-    memcpy(&arena.data[0], &st->empty_arena_.data[0],
-           items_offset * sizeof(arena.data[0]));
-#else
-    TGStrView sprite_space = st->sprite_space;
-    for (size_t i = 1; i < items_offset; i++) { arena.data[i] = sprite_space; }
-#endif
+    TGuyClearMode mode = st->clear_mode_;
+    if (mode == TGUY_CLEAR_AUTO) {
+        mode = (items_offset < TGUY_CLEAR_LOOP_MAX) ? TGUY_CLEAR_LOOP : TGUY_CLEAR_FILL;
+    }
+    if (mode == TGUY_CLEAR_SHADOW) {
+        /* linear memory copy is way faster than the loop to fill the arena with spaces */
+        memcpy(&arena.data[0], &st->empty_arena_[0], items_offset * sizeof(arena.data[0]));
+    } else if (mode == TGUY_CLEAR_FILL && items_offset > 1) {
+        /* same without the extra memory: every copy doubles the number of spaces filled */
+        size_t filled = 1;
+        arena.data[1] = st->sprite_space;
+        while (1 + filled < items_offset) {
+            size_t n = (filled < items_offset - 1 - filled) ? filled : items_offset - 1 - filled;
+            memcpy(&arena.data[1 + filled], &arena.data[1], n * sizeof(arena.data[0]));
+            filled += n;
+        }
+    } else {
+        TGStrView sprite_space = st->sprite_space;
+        for (size_t i = 1; i < items_offset; i++) { arena.data[i] = sprite_space; }
+    }
     memcpy(&arena.data[items_offset], &text.data[n_clear_elements],
            sizeof(st->arena.data[0]) * (text.len - n_clear_elements));
 }
 
-TrashGuyState *tguy_from_arr_ex_2(const TGStrView arr[],
-                                  size_t len,
-                                  unsigned spacing,
-                                  const TGStrView *sprite_space,
-                                  const TGStrView *sprite_can,
-                                  const TGStrView *sprite_right,
-                                  const TGStrView *sprite_left,
-                                  int preserve_strings) {
-    if (arr == NULL) len = 0;
+/**
+ *  Allocates TrashGuyState with everything but the text elements set up, sprites are copied into it.
+ *  Caller must fill TrashGuyState::text and then call tguy_state_init()
+ * @param len          Number of text elements
+ * @param spacing      Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @param text_len     Number of bytes to reserve for text strings in front of the sprites
+ * @param sprite_space Sprite to be used as empty space or NULL for default one
+ * @param sprite_can   Sprite to be used as trash can or NULL for default one
+ * @param sprite_right Sprite to be used when TrashGuy moves right or NULL for default one
+ * @param sprite_left  Sprite to be used when TrashGuy moves left or NULL for default one
+ * @param[out] text_mem Where reserved text_len bytes start
+ * @return             TrashGuyState * or NULL on allocation failure
+ */
+static TrashGuyState *tguy_state_alloc(size_t len,
+                                       unsigned spacing,
+                                       size_t text_len,
+                                       const TGStrView *sprite_space,
+                                       const TGStrView *sprite_can,
+                                       const TGStrView *sprite_right,
+                                       const TGStrView *sprite_left,
+                                       char **text_mem) {
     struct TrashGuyState *st;
-    size_t str_len = 0;
-    char *str_mem = NULL;
+    size_t str_len;
+    char *str_mem;
     const size_t
         arena_size = 2 + spacing + len + 1, /* 3 additional places for: can, tguy sprite and nul */
-        all_fields_len = (
-            len
-            + arena_size
-#ifdef TGUY_FASTCLEAR
-            /* additional memory for empty arena */
-            + arena_size
-#endif
-        ),
+        all_fields_len = len + arena_size,
         str_mem_off = offsetof(TrashGuyState, views_mem) + (sizeof(TGStrView) * all_fields_len);
     TGStrView
         sv_right = (sprite_right) ? *sprite_right : TGSTRV("(> ^_^)>"),
@@ -179,13 +227,11 @@ TrashGuyState *tguy_from_arr_ex_2(const TGStrView arr[],
         sv_space = (sprite_space) ? *sprite_space : TGSTRV(" ");
 
     assert((ignored_"len is too big", len < (unsigned) -1));
-    if (preserve_strings) {
-        str_len = strvarr_strlen(arr, len)
-            + sv_right.len
-            + sv_left.len
-            + sv_can.len
-            + sv_space.len;
-    }
+    str_len = text_len
+        + sv_right.len
+        + sv_left.len
+        + sv_can.len
+        + sv_space.len;
     st = malloc(str_mem_off + str_len);
     if (st == NULL) return NULL;
 
@@ -206,59 +252,41 @@ TrashGuyState *tguy_from_arr_ex_2(const TGStrView arr[],
         arena_size - 1 /* minus nul */
     };
 
-#ifdef TGUY_FASTCLEAR
-    /* fastclear option exploits the fact that linear memory copy is way faster to fill the arena with spaces */
-    st->empty_arena_ = (TGStrViewArr){
-        st->arena.data + arena_size,
-        st->arena.len
-    };
-#endif
-
-    if (preserve_strings) {
-        /* copy strings from views to allocated linear memory block, then assign new addresses to views */
-        char *str_base;
-        str_mem = (char *)st + str_mem_off;
-        str_base = str_mem;
-        str_mem += strvarr_write(str_mem, arr, len);
-
-        st->sprite_right.str = str_mem;
-        str_mem += strvarr_write(str_mem, &sv_right, 1);
+    /* text strings go first, sprites after them */
+    str_mem = (char *)st + str_mem_off;
+    *text_mem = str_mem;
+    /* copy sprites to allocated linear memory block, then assign new addresses to views */
+    str_mem += text_len;
 
-        st->sprite_left.str = str_mem;
-        str_mem += strvarr_write(str_mem, &sv_left, 1);
+    st->sprite_right.str = str_mem;
+    str_mem += strvarr_write(str_mem, &sv_right, 1);
 
-        st->sprite_can.str = str_mem;
-        str_mem += strvarr_write(str_mem, &sv_can, 1);
+    st->sprite_left.str = str_mem;
+    str_mem += strvarr_write(str_mem, &sv_left, 1);
 
-        st->sprite_space.str = str_mem;
-        (void)strvarr_write(str_mem, &sv_space, 1);
+    st->sprite_can.str = str_mem;
+    str_mem += strvarr_write(str_mem, &sv_can, 1);
 
-        str_mem = str_base;
-    }
+    st->sprite_space.str = str_mem;
+    (void)strvarr_write(str_mem, &sv_space, 1);
 
     /* fields initialization */
     st->arena.data[0] = st->sprite_can;
     st->arena.data[st->arena.len] = (TGStrView){NULL, 0};
 
-#ifdef TGUY_FASTCLEAR
-    /* empty arena has the same size as arena, it's only filled with spaces and trash can sprite as first element */
-    st->empty_arena_.data[0] = st->sprite_can;
-    st->empty_arena_.data[st->empty_arena_.len] = (TGStrView){NULL, 0};
-    for (size_t i = 1, flen = st->empty_arena_.len; i < flen; i++) {
-        st->empty_arena_.data[i] = st->sprite_space;
-    }
-#endif
-
-    if (preserve_strings) {
-        strvarr_copy_src(st->text.data, arr, len, str_mem);
-    } else {
-        strvarr_copy(st->text.data, arr, len);
-    }
-
     /* one frame for initial pos, spacing frames to walk over empty space to the first element, x2 to return back */
     st->first_element_frames_count = (spacing + 1) * 2;
+    return st;
+}
+
+/**
+ *  Finishes construction of TrashGuyState allocated by tguy_state_alloc() once its text is filled and sets frame 0
+ * @param st           TrashGuyState returned by tguy_state_alloc()
+ */
+static void tguy_state_init(TrashGuyState *st) {
     /* not computed yet and may not be computed at all */
     st->buf_size = 0;
+    st->cell_size = 0;
     /* used to determine whether we should run set_frame and for unset assertions */
     st->cur_frame = (unsigned)-1;
     /* current element index we're working on, reduces computation for sequential set_frame */
@@ -267,8 +295,50 @@ TrashGuyState *tguy_from_arr_ex_2(const TGStrView arr[],
     /* number of frames up to the last + 1 */
     st->max_frames = get_first_frame_for_element(st->first_element_frames_count, (unsigned)st->text.len) + 1;
     st->output_str = NULL;
+    st->owned_mem_ = NULL;
+    st->lazy_src_ = NULL;
+    st->utf16_ = NULL;
+    st->utf32_ = NULL;
+    st->empty_arena_ = NULL;
+    st->clear_mode_ = TGUY_CLEAR_AUTO;
+#ifdef TGUY_FASTCLEAR
+    /* fastclear build option makes shadow arena the default, allocation failure keeps the auto mode */
+    ignored_ tguy_set_clear_mode(st, TGUY_CLEAR_SHADOW);
+#endif
+    st->grid_cell = 0;
+    st->grid_valid = 0;
+    if (st->sprite_space.len && st->sprite_right.len == st->sprite_left.len) {
+        size_t i = 0;
+        while (i < st->text.len && st->text.data[i].len == st->sprite_space.len) i++;
+        if (i == st->text.len) st->grid_cell = st->sprite_space.len;
+    }
 
     tguy_set_frame(st, 0);
+}
+
+TrashGuyState *tguy_from_arr_ex_2(const TGStrView arr[],
+                                  size_t len,
+                                  unsigned spacing,
+                                  const TGStrView *sprite_space,
+                                  const TGStrView *sprite_can,
+                                  const TGStrView *sprite_right,
+                                  const TGStrView *sprite_left,
+                                  int preserve_strings) {
+    TrashGuyState *st;
+    char *str_mem;
+    if (arr == NULL) len = 0;
+    st = tguy_state_alloc(len, spacing, preserve_strings ? strvarr_strlen(arr, len) : 0,
+                          sprite_space, sprite_can, sprite_right, sprite_left, &str_mem);
+    if (st == NULL) return NULL;
+
+    if (preserve_strings) {
+        /* copy strings from views to allocated linear memory block, then assign new addresses to views */
+        strvarr_write(str_mem, arr, len);
+        strvarr_copy_src(st->text.data, arr, len, str_mem);
+    } else {
+        strvarr_copy(st->text.data, arr, len);
+    }
+    tguy_state_init(st);
     return st;
 }
 
@@ -326,6 +396,33 @@ static size_t tguy_graphemes_len(const char *str, size_t len) {
     return read_bytes != (size_t)-1 ? rlen : (size_t)-1;
 }
 
+#elif defined TGUY_USE_LIBGRAPHEME
+/* libgrapheme decodes invalid utf-8 sequences as U+FFFD, so it never fails */
+static size_t tguy_next_break(const char *str, size_t len) {
+    size_t n = grapheme_next_character_break_utf8(str, len);
+    /* always make progress */
+    return n ? n : 1;
+}
+
+static size_t tguy_iterate_graphemes(
+    const char *str, size_t *read_bytes, size_t strlen,
+    size_t *start, size_t *end
+) {
+    if (*read_bytes == strlen) return 0;
+    *start = *read_bytes;
+    *end = *start + tguy_next_break(&str[*start], strlen - *start);
+    *read_bytes = *end;
+    return *end - *start;
+}
+
+static size_t tguy_graphemes_len(const char *str, size_t len) {
+    size_t count = 0;
+    for (size_t off = 0; off < len; count++) {
+        off += tguy_next_break(&str[off], len - off);
+    }
+    return count;
+}
+
 #elif defined TGUY_USE_WGRAPHEME
 static size_t tguy_iterate_graphemes(
     const char *str, size_t *read_bytes, size_t strlen,
@@ -373,25 +470,131 @@ static char *tguy_utf8_next(const char *begin, const char *end) {
     return (char *) begin;
 }
 
-static size_t tguy_codepoints_len(const char *string, size_t len) {
+/* same as grapheme backends iterators, but yields codepoints */
+static size_t tguy_iterate_graphemes(
+    const char *str, size_t *read_bytes, size_t strlen,
+    size_t *start, size_t *end
+) {
+    const char *next;
+    if (*read_bytes == strlen) return 0;
+    *start = *read_bytes;
+    next = tguy_utf8_next(&str[*start], &str[strlen]);
+    /* invalid lead byte is taken as is, truncated sequence takes the rest of the string */
+    if (next == &str[*start]) next++;
+    *end = (next > &str[strlen]) ? strlen : (size_t)(next - str);
+    *read_bytes = *end;
+    return *end - *start;
+}
+
+/* number of codepoints */
+static size_t tguy_graphemes_len(const char *str, size_t len) {
+    size_t read_bytes = 0;
+    size_t start, end;
     size_t rlen = 0;
-    const char *start = string, *end = string + len;
-    while ((start = tguy_utf8_next(start, end))) {
+    while (tguy_iterate_graphemes(str, &read_bytes, len, &start, &end)) {
         rlen++;
     }
     return rlen;
 }
 #endif
 
+/**
+ *  Returns length of str without trailing utf-8 sequence that isn't complete yet
+ * @param str  utf-8 string
+ * @param len  number of bytes in str
+ * @return     len or offset of the incomplete sequence
+ */
+static size_t utf8_complete_len(const char *str, size_t len) {
+    size_t lead = len, need;
+    unsigned char c;
+    while (lead > 0 && len - lead < 4 && ((unsigned char)str[lead - 1] & 0xC0) == 0x80) lead--;
+    if (lead == 0) return len;
+    c = (unsigned char)str[--lead];
+    if ((c & 0xE0) == 0xC0) {
+        need = 2;
+    } else if ((c & 0xF0) == 0xE0) {
+        need = 3;
+    } else if ((c & 0xF8) == 0xF0) {
+        need = 4;
+    } else {
+        need = 1;
+    }
+    return (len - lead < need) ? lead : len;
+}
+
 
-TrashGuyState *tguy_from_utf8_ex(const char string[], size_t len, unsigned spacing,
-                                 const char *sprite_space, size_t sprite_space_len,
-                                 const char *sprite_can, size_t sprite_can_len,
-                                 const char *sprite_right, size_t sprite_right_len,
-                                 const char *sprite_left, size_t sprite_left_len) {
-    TrashGuyState *st = NULL;
-    TGStrView *strarr = NULL;
+/**
+ *  Splits more of TrashGuyState::lazy_src_ into elements and appends them to text and arena.
+ *  Elements to the right of the one being processed are only drawn as they are, so the rest of text
+ *  is kept as a single last element, it's never cleared or carried before being segmented. \n
+ *  Each call at least doubles the number of elements to keep the total work linear.
+ * @param st           Valid lazy TrashGuyState
+ * @param min_elements Minimum number of segmented elements to have, -1 to segment everything
+ * @return             0 on success, -1 on allocation failure, state isn't changed then
+ */
+static int tguy_lazy_segment(TrashGuyState *st, size_t min_elements) {
+    size_t n_seg = st->text.len - (st->lazy_seg_ < st->lazy_len_);
+    size_t old_len = st->text.len;
+    size_t items_offset = st->arena.len - st->text.len;
+    size_t target = n_seg * 2;
+    size_t read_bytes = st->lazy_seg_;
+    size_t seg = st->lazy_seg_;
+    size_t start, end;
+
+    if (st->lazy_seg_ == st->lazy_len_ || n_seg >= min_elements) return 0;
+    if (target < 64) target = 64;
+    if (target < min_elements) target = min_elements;
+
+    /* new elements go past the committed ones, the rest of text is only replaced once nothing can fail */
+    while (n_seg < target && tguy_iterate_graphemes(st->lazy_src_, &read_bytes, st->lazy_len_, &start, &end)) {
+        /* new elements are stored one slot further, which the new rest of text takes after commit */
+        if (n_seg + 2 > st->lazy_cap_) {
+            size_t cap = st->lazy_cap_ * 2;
+            TGStrView *text = realloc(st->text.data, sizeof(text[0]) * cap);
+            if (text == NULL) return -1;
+            st->text.data = text;
+            TGStrView *arena = realloc(st->arena.data, sizeof(arena[0]) * (items_offset + cap + 1));
+            if (arena == NULL) return -1;
+            st->arena.data = arena;
+            st->lazy_cap_ = cap;
+        }
+        st->text.data[++n_seg] = (TGStrView){&st->lazy_src_[start], end - start};
+        seg = end;
+    }
+    /* commit: elements move one slot down over the old rest of text */
+    if (n_seg > old_len - 1) {
+        memmove(&st->text.data[old_len - 1], &st->text.data[old_len], sizeof(st->text.data[0]) * (n_seg - old_len + 1));
+    }
+    st->lazy_seg_ = seg;
+    st->text.len = n_seg;
+    if (st->lazy_seg_ < st->lazy_len_) {
+        st->text.data[st->text.len++] = (TGStrView){&st->lazy_src_[st->lazy_seg_], st->lazy_len_ - st->lazy_seg_};
+        /* invalid utf-8 stops segmentation, the rest of text is kept as a single element */
+        if (read_bytes == (size_t)-1) st->lazy_seg_ = st->lazy_len_;
+    }
+    /* cell of the old rest of text and everything after it show text as is */
+    for (size_t i = old_len - 1; i < st->text.len; i++) {
+        st->arena.data[items_offset + i] = st->text.data[i];
+    }
+    st->arena.len = items_offset + st->text.len;
+    st->arena.data[st->arena.len] = (TGStrView){NULL, 0};
+
+    if (st->lazy_seg_ == st->lazy_len_) {
+        st->max_frames = get_first_frame_for_element(st->first_element_frames_count, (unsigned)st->text.len) + 1;
+    }
+    return 0;
+}
+
+TrashGuyState *tguy_from_utf8_ex_2(const char string[], size_t len, unsigned spacing,
+                                   const char *sprite_space, size_t sprite_space_len,
+                                   const char *sprite_can, size_t sprite_can_len,
+                                   const char *sprite_right, size_t sprite_right_len,
+                                   const char *sprite_left, size_t sprite_left_len,
+                                   int preserve_strings) {
+    TrashGuyState *st;
     TGStrView sv_sprite_space, sv_sprite_can, sv_sprite_right, sv_sprite_left;
+    const char *src = string;
+    char *str_mem;
     size_t flen = 0;
 
     if (string == NULL) len = 0;
@@ -399,44 +602,48 @@ TrashGuyState *tguy_from_utf8_ex(const char string[], size_t len, unsigned spaci
     len = (len == (size_t)-1) ? strlen(string) : len;
 
     if (len > 0) {
-#ifndef TGUY_NO_GRAPHEME
         flen = tguy_graphemes_len(string, len);
-#else
-        flen = tguy_codepoints_len(string, len);
-#endif
         if (flen == (size_t)-1 || flen > INT_MAX) return NULL;
-
-        if (flen) {
-            strarr = malloc(sizeof(strarr[0]) * flen);
-            if (strarr == NULL) return NULL;
-
-            size_t i = 0;
-#ifndef  TGUY_NO_GRAPHEME
-            /* fill the array with ranges of the string representing whole utf-8 grapheme clusters */
-            size_t read_bytes = 0;
-            size_t start, end;
-            while (tguy_iterate_graphemes(string, &read_bytes, len, &start, &end)) {
-                cstr2tgstrv(&strarr[i++], &string[start], end - start);
-            }
-#else
-            const char *start = string, *end = string + len;
-            while ((start = tguy_utf8_next(start, end))) {
-                cstr2tgstrv(&strarr[i++], string, start - string);
-                string = start;
-            }
-#endif
-        }
     }
 
-    st = tguy_from_arr_ex(strarr, flen, spacing,
+    st = tguy_state_alloc(flen, spacing, preserve_strings ? len : 0,
                           sprite_space ? cstr2tgstrv(&sv_sprite_space, sprite_space, sprite_space_len) : NULL,
                           sprite_can ? cstr2tgstrv(&sv_sprite_can, sprite_can, sprite_can_len) : NULL,
                           sprite_right ? cstr2tgstrv(&sv_sprite_right, sprite_right, sprite_right_len) : NULL,
-                          sprite_left ? cstr2tgstrv(&sv_sprite_left, sprite_left, sprite_left_len) : NULL);
-    free(strarr);
+                          sprite_left ? cstr2tgstrv(&sv_sprite_left, sprite_left, sprite_left_len) : NULL,
+                          &str_mem);
+    if (st == NULL) return NULL;
+    if (preserve_strings && len) {
+        memcpy(str_mem, string, len);
+        src = str_mem;
+    }
+
+    if (flen) {
+        /* fill the array with ranges of the string representing whole utf-8 grapheme clusters */
+        size_t i = 0;
+        size_t read_bytes = 0;
+        size_t start, end;
+        while (i < flen && tguy_iterate_graphemes(src, &read_bytes, len, &start, &end)) {
+            st->text.data[i++] = (TGStrView){&src[start], end - start};
+        }
+    }
+    tguy_state_init(st);
     return st;
 }
 
+TrashGuyState *tguy_from_utf8_ex(const char string[], size_t len, unsigned spacing,
+                                 const char *sprite_space, size_t sprite_space_len,
+                                 const char *sprite_can, size_t sprite_can_len,
+                                 const char *sprite_right, size_t sprite_right_len,
+                                 const char *sprite_left, size_t sprite_left_len) {
+    return tguy_from_utf8_ex_2(string, len, spacing,
+                               sprite_space, sprite_space_len,
+                               sprite_can, sprite_can_len,
+                               sprite_right, sprite_right_len,
+                               sprite_left, sprite_left_len,
+                               1);
+}
+
 TrashGuyState *tguy_from_utf8(const char string[], size_t len, unsigned spacing) {
     return tguy_from_utf8_ex(string, len, spacing,
                              NULL, 0,
@@ -445,35 +652,359 @@ TrashGuyState *tguy_from_utf8(const char string[], size_t len, unsigned spacing)
                              NULL, 0);
 }
 
-TrashGuyState *tguy_from_cstr_arr_ex(const char *const arr[], size_t len, unsigned spacing,
-                                     const char *sprite_space, size_t sprite_space_len,
-                                     const char *sprite_can, size_t sprite_can_len,
-                                     const char *sprite_right, size_t sprite_right_len,
-                                     const char *sprite_left, size_t sprite_left_len) {
+/**
+ * Text accumulated by tguy_builder_feed(), segmented as it arrives
+ */
+struct TGuyBuilder {
+    char *pool; /**< text received so far, later handed over to TrashGuyState::owned_mem_ */
+    size_t pool_len; /**< number of bytes in pool */
+    size_t pool_cap; /**< capacity of pool */
+    size_t *ends; /**< end offsets of elements segmented so far */
+    size_t n_ends; /**< number of elements segmented so far */
+    size_t ends_cap; /**< capacity of ends */
+    size_t seg_start; /**< start of the element which may still grow with the next chunk */
+    unsigned spacing; /**< passed to the constructor */
+    char *sprites_mem; /**< copies of user-defined sprites */
+    size_t sprite_lens[4]; /**< space, can, right, left sprite lengths, -1 if default sprite is used */
+    int failed; /**< set on allocation failure or invalid input */
+};
+
+/**
+ *  Segments builder text up to end
+ * @param b      Valid TGuyBuilder
+ * @param end    Segment up to this offset of TGuyBuilder::pool
+ * @param final  If not set, last element is not confirmed, since continuation of text may still join it
+ * @return       0 on success, -1 on failure
+ */
+static int builder_segment(TGuyBuilder *b, size_t end, int final) {
+    size_t read_bytes = b->seg_start;
+    size_t start, stop;
+    while (tguy_iterate_graphemes(b->pool, &read_bytes, end, &start, &stop)) {
+        if (stop == end && !final) break;
+        if (b->n_ends == b->ends_cap) {
+            size_t cap = b->ends_cap ? b->ends_cap * 2 : 64;
+            size_t *ends = realloc(b->ends, sizeof(ends[0]) * cap);
+            if (ends == NULL) return -1;
+            b->ends = ends;
+            b->ends_cap = cap;
+        }
+        b->ends[b->n_ends++] = stop;
+        b->seg_start = stop;
+    }
+    return (read_bytes == (size_t)-1) ? -1 : 0;
+}
+
+TGuyBuilder *tguy_builder_new(unsigned spacing,
+                              const char *sprite_space, size_t sprite_space_len,
+                              const char *sprite_can, size_t sprite_can_len,
+                              const char *sprite_right, size_t sprite_right_len,
+                              const char *sprite_left, size_t sprite_left_len) {
+    TGuyBuilder *b = malloc(sizeof(*b));
+    TGStrView sprites[4];
+    const char *sprite_ptrs[4] = {sprite_space, sprite_can, sprite_right, sprite_left};
+    size_t sprite_lens[4] = {sprite_space_len, sprite_can_len, sprite_right_len, sprite_left_len};
+    size_t sprites_len = 0;
+    if (b == NULL) return NULL;
+    for (size_t i = 0; i < 4; i++) {
+        if (sprite_ptrs[i] == NULL) continue;
+        cstr2tgstrv(&sprites[i], sprite_ptrs[i], sprite_lens[i]);
+        sprites_len += sprites[i].len;
+    }
+    b->sprites_mem = malloc(sprites_len + 1);
+    if (b->sprites_mem == NULL) {
+        free(b);
+        return NULL;
+    }
+    sprites_len = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (sprite_ptrs[i] == NULL) {
+            b->sprite_lens[i] = (size_t)-1;
+            continue;
+        }
+        b->sprite_lens[i] = strvarr_write(&b->sprites_mem[sprites_len], &sprites[i], 1);
+        sprites_len += b->sprite_lens[i];
+    }
+    b->pool = NULL;
+    b->pool_len = 0;
+    b->pool_cap = 0;
+    b->ends = NULL;
+    b->n_ends = 0;
+    b->ends_cap = 0;
+    b->seg_start = 0;
+    b->spacing = spacing;
+    b->failed = 0;
+    return b;
+}
+
+int tguy_builder_feed(TGuyBuilder *b, const char *chunk, size_t len) {
+    if (b->failed) return -1;
+    if (chunk == NULL) return 0;
+    len = (len == (size_t)-1) ? strlen(chunk) : len;
+    if (len == 0) return 0;
+    if (b->pool_cap - b->pool_len < len) {
+        size_t cap = b->pool_cap ? b->pool_cap : 4096;
+        while (cap - b->pool_len < len) cap *= 2;
+        char *pool = realloc(b->pool, cap);
+        if (pool == NULL) {
+            b->failed = 1;
+            return -1;
+        }
+        b->pool = pool;
+        b->pool_cap = cap;
+    }
+    memcpy(&b->pool[b->pool_len], chunk, len);
+    b->pool_len += len;
+    /* utf-8 sequence split between chunks is segmented once the rest of it arrives */
+    if (builder_segment(b, utf8_complete_len(b->pool, b->pool_len), 0) != 0) {
+        b->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+void tguy_builder_free(TGuyBuilder *b) {
+    if (b == NULL) return;
+    free(b->pool);
+    free(b->ends);
+    free(b->sprites_mem);
+    free(b);
+}
+
+TrashGuyState *tguy_builder_finish(TGuyBuilder *b) {
+    TrashGuyState *st = NULL;
+    TGStrView *strarr = NULL;
+    TGStrView sprites[4];
+    size_t sprites_len = 0;
+    char *pool;
+
+    if (b->failed || builder_segment(b, b->pool_len, 1) != 0 || b->n_ends > INT_MAX) goto end;
+
+    /* sprites are kept at the end of the text, so that the state owns single block of strings */
+    for (size_t i = 0; i < 4; i++) {
+        if (b->sprite_lens[i] != (size_t)-1) sprites_len += b->sprite_lens[i];
+    }
+    pool = realloc(b->pool, b->pool_len + sprites_len + 1);
+    if (pool == NULL) goto end;
+    b->pool = pool;
+    memcpy(&pool[b->pool_len], b->sprites_mem, sprites_len);
+    sprites_len = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (b->sprite_lens[i] == (size_t)-1) continue;
+        sprites[i] = (TGStrView){&pool[b->pool_len + sprites_len], b->sprite_lens[i]};
+        sprites_len += b->sprite_lens[i];
+    }
+
+    if (b->n_ends) {
+        strarr = malloc(sizeof(strarr[0]) * b->n_ends);
+        if (strarr == NULL) goto end;
+        for (size_t i = 0, start = 0; i < b->n_ends; i++) {
+            strarr[i] = (TGStrView){&pool[start], b->ends[i] - start};
+            start = b->ends[i];
+        }
+    }
+
+    st = tguy_from_arr_ex_2(strarr, b->n_ends, b->spacing,
+                            (b->sprite_lens[0] != (size_t)-1) ? &sprites[0] : NULL,
+                            (b->sprite_lens[1] != (size_t)-1) ? &sprites[1] : NULL,
+                            (b->sprite_lens[2] != (size_t)-1) ? &sprites[2] : NULL,
+                            (b->sprite_lens[3] != (size_t)-1) ? &sprites[3] : NULL,
+                            0);
+    if (st != NULL) {
+        st->owned_mem_ = pool;
+        b->pool = NULL;
+    }
+end:
+    free(strarr);
+    tguy_builder_free(b);
+    return st;
+}
+
+TrashGuyState *tguy_from_utf8_offsets(const char string[], size_t len,
+                                      const uint32_t offsets[], size_t n, unsigned spacing,
+                                      const char *sprite_space, size_t sprite_space_len,
+                                      const char *sprite_can, size_t sprite_can_len,
+                                      const char *sprite_right, size_t sprite_right_len,
+                                      const char *sprite_left, size_t sprite_left_len,
+                                      int preserve_strings) {
+    TrashGuyState *st;
+    TGStrView sv_sprite_space, sv_sprite_can, sv_sprite_right, sv_sprite_left;
+    const char *src = string;
+    char *str_mem;
+
+    if (string == NULL || offsets == NULL) len = n = 0;
+    len = (len == (size_t)-1) ? strlen(string) : len;
+    /* offsets must cover the whole string */
+    if ((n == 0) != (len == 0) || n > INT_MAX || (n && offsets[0] != 0)) return NULL;
+    for (size_t i = 1; i < n; i++) {
+        if (offsets[i] <= offsets[i - 1]) return NULL;
+    }
+    if (n && offsets[n - 1] >= len) return NULL;
+
+    st = tguy_state_alloc(n, spacing, preserve_strings ? len : 0,
+                          sprite_space ? cstr2tgstrv(&sv_sprite_space, sprite_space, sprite_space_len) : NULL,
+                          sprite_can ? cstr2tgstrv(&sv_sprite_can, sprite_can, sprite_can_len) : NULL,
+                          sprite_right ? cstr2tgstrv(&sv_sprite_right, sprite_right, sprite_right_len) : NULL,
+                          sprite_left ? cstr2tgstrv(&sv_sprite_left, sprite_left, sprite_left_len) : NULL,
+                          &str_mem);
+    if (st == NULL) return NULL;
+    if (preserve_strings && len) {
+        memcpy(str_mem, string, len);
+        src = str_mem;
+    }
+    for (size_t i = 0; i < n; i++) {
+        size_t end = (i + 1 < n) ? offsets[i + 1] : len;
+        st->text.data[i] = (TGStrView){&src[offsets[i]], end - offsets[i]};
+    }
+    tguy_state_init(st);
+    return st;
+}
+
+TrashGuyState *tguy_from_utf8_lazy_ex_2(const char string[], size_t len, unsigned spacing,
+                                        const char *sprite_space, size_t sprite_space_len,
+                                        const char *sprite_can, size_t sprite_can_len,
+                                        const char *sprite_right, size_t sprite_right_len,
+                                        const char *sprite_left, size_t sprite_left_len,
+                                        int preserve_strings) {
+    TrashGuyState *st;
+    TGStrView sv_sprite_space, sv_sprite_can, sv_sprite_right, sv_sprite_left;
+    TGStrView *arena;
+    const char *src = string ? string : "";
+    size_t items_offset;
+
+    if (string == NULL) len = 0;
+    len = (len == (size_t)-1) ? strlen(string) : len;
+
+    /* state without elements holds the sprites, text and arena are then moved to growing arrays */
+    st = tguy_from_arr_ex(NULL, 0, spacing,
+                          sprite_space ? cstr2tgstrv(&sv_sprite_space, sprite_space, sprite_space_len) : NULL,
+                          sprite_can ? cstr2tgstrv(&sv_sprite_can, sprite_can, sprite_can_len) : NULL,
+                          sprite_right ? cstr2tgstrv(&sv_sprite_right, sprite_right, sprite_right_len) : NULL,
+                          sprite_left ? cstr2tgstrv(&sv_sprite_left, sprite_left, sprite_left_len) : NULL);
+    if (st == NULL) return NULL;
+    /* arena of lazy state grows, so it can't have an empty arena to copy from */
+    ignored_ tguy_set_clear_mode(st, TGUY_CLEAR_AUTO);
+    if (preserve_strings) {
+        char *copy = malloc(len + 1);
+        if (copy == NULL) {
+            tguy_free(st);
+            return NULL;
+        }
+        if (len) memcpy(copy, string, len);
+        st->owned_mem_ = copy;
+        src = copy;
+    }
+
+    items_offset = st->arena.len;
+    st->lazy_cap_ = 64;
+    st->text.data = malloc(sizeof(st->text.data[0]) * st->lazy_cap_);
+    arena = malloc(sizeof(arena[0]) * (items_offset + st->lazy_cap_ + 1));
+    if (st->text.data == NULL || arena == NULL) {
+        free(st->text.data);
+        free(arena);
+        tguy_free(st);
+        return NULL;
+    }
+    memcpy(arena, st->arena.data, sizeof(arena[0]) * items_offset);
+    st->arena.data = arena;
+    /* whole text starts as the unsegmented rest */
+    if (len) {
+        st->text.data[0] = (TGStrView){src, len};
+        st->text.len = 1;
+        arena[items_offset] = st->text.data[0];
+    }
+    st->arena.len = items_offset + st->text.len;
+    arena[st->arena.len] = (TGStrView){NULL, 0};
+    st->lazy_src_ = src;
+    st->lazy_len_ = len;
+    /* rest of text is a single element, so lazy states never form a grid */
+    st->grid_cell = 0;
+    st->lazy_seg_ = 0;
+    /* unknown until everything is segmented, empty text is segmented already */
+    if (len) st->max_frames = (unsigned)-1;
+
+    if (tguy_lazy_segment(st, 1) != 0) {
+        tguy_free(st);
+        return NULL;
+    }
+    st->cur_frame = (unsigned)-1;
+    tguy_set_frame(st, 0);
+    return st;
+}
+
+TrashGuyState *tguy_from_utf8_lazy_ex(const char string[], size_t len, unsigned spacing,
+                                      const char *sprite_space, size_t sprite_space_len,
+                                      const char *sprite_can, size_t sprite_can_len,
+                                      const char *sprite_right, size_t sprite_right_len,
+                                      const char *sprite_left, size_t sprite_left_len) {
+    return tguy_from_utf8_lazy_ex_2(string, len, spacing,
+                                    sprite_space, sprite_space_len,
+                                    sprite_can, sprite_can_len,
+                                    sprite_right, sprite_right_len,
+                                    sprite_left, sprite_left_len,
+                                    1);
+}
+
+TrashGuyState *tguy_from_utf8_lazy(const char string[], size_t len, unsigned spacing) {
+    return tguy_from_utf8_lazy_ex(string, len, spacing,
+                                  NULL, 0,
+                                  NULL, 0,
+                                  NULL, 0,
+                                  NULL, 0);
+}
+
+TrashGuyState *tguy_from_cstr_arr_ex_2(const char *const arr[], size_t len, unsigned spacing,
+                                       const char *sprite_space, size_t sprite_space_len,
+                                       const char *sprite_can, size_t sprite_can_len,
+                                       const char *sprite_right, size_t sprite_right_len,
+                                       const char *sprite_left, size_t sprite_left_len,
+                                       int preserve_strings) {
     TrashGuyState *st;
     TGStrView sv_sprite_space, sv_sprite_can, sv_sprite_right, sv_sprite_left;
-    TGStrView *svarr = NULL;
+    char *str_mem;
+    size_t text_len = 0;
 
-    if (arr != NULL && len != 0) {
-        svarr = malloc(sizeof(svarr[0]) * len);
-        if (svarr == NULL) return NULL;
-        /* create array of string views from C array */
+    if (arr == NULL) len = 0;
+    if (preserve_strings) {
         for (size_t i = 0; i < len; i++) {
-            cstr2tgstrv(&svarr[i], arr[i], (size_t)-1);
+            text_len += arr[i] ? strlen(arr[i]) : 0;
         }
-    } else {
-        len = 0;
     }
 
-    st = tguy_from_arr_ex(svarr, len, spacing,
+    st = tguy_state_alloc(len, spacing, text_len,
                           sprite_space ? cstr2tgstrv(&sv_sprite_space, sprite_space, sprite_space_len) : NULL,
                           sprite_can ? cstr2tgstrv(&sv_sprite_can, sprite_can, sprite_can_len) : NULL,
                           sprite_right ? cstr2tgstrv(&sv_sprite_right, sprite_right, sprite_right_len) : NULL,
-                          sprite_left ? cstr2tgstrv(&sv_sprite_left, sprite_left, sprite_left_len) : NULL);
-    free(svarr);
+                          sprite_left ? cstr2tgstrv(&sv_sprite_left, sprite_left, sprite_left_len) : NULL,
+                          &str_mem);
+    if (st == NULL) return NULL;
+
+    /* create array of string views from C array, strings are either borrowed or copied to linear memory block */
+    for (size_t i = 0; i < len; i++) {
+        TGStrView *sv = &st->text.data[i];
+        cstr2tgstrv(sv, arr[i], (size_t)-1);
+        if (preserve_strings) {
+            if (sv->len) memcpy(str_mem, sv->str, sv->len);
+            sv->str = str_mem;
+            str_mem += sv->len;
+        }
+    }
+    tguy_state_init(st);
     return st;
 }
 
+TrashGuyState *tguy_from_cstr_arr_ex(const char *const arr[], size_t len, unsigned spacing,
+                                     const char *sprite_space, size_t sprite_space_len,
+                                     const char *sprite_can, size_t sprite_can_len,
+                                     const char *sprite_right, size_t sprite_right_len,
+                                     const char *sprite_left, size_t sprite_left_len) {
+    return tguy_from_cstr_arr_ex_2(arr, len, spacing,
+                                   sprite_space, sprite_space_len,
+                                   sprite_can, sprite_can_len,
+                                   sprite_right, sprite_right_len,
+                                   sprite_left, sprite_left_len,
+                                   1);
+}
+
 TrashGuyState *tguy_from_cstr_arr(const char *const arr[], size_t len, unsigned spacing) {
     return tguy_from_cstr_arr_ex(arr, len, spacing,
                                  NULL, 0,
@@ -486,9 +1017,35 @@ TrashGuyState *tguy_from_cstr_arr(const char *const arr[], size_t len, unsigned
 void tguy_free(TrashGuyState *st) {
     if (st == NULL) return;
     free(st->output_str);
+    free(st->owned_mem_);
+    free(st->utf16_);
+    free(st->utf32_);
+    free(st->empty_arena_);
+    if (st->lazy_src_ != NULL) {
+        free(st->text.data);
+        free(st->arena.data);
+    }
     free(st);
 }
 
+/**
+ *  Redraws cells [i, i + 2] of the grid in TrashGuyState::output_str after sequential tguy_set_frame().
+ *  These are the only cells sequential frame changes, TrashGuy sprite is among them both before and after the change,
+ *  so cells to the left have the same offset and the size of the range stays the same
+ * @param st  Valid TrashGuyState in grid mode with TrashGuyState::output_str holding the previous frame
+ * @param i   Index of TrashGuy in the arena minus one
+ */
+static void grid_patch(const TrashGuyState *st, unsigned i) {
+    /* trash can is never touched */
+    size_t first = (i == 0) ? 1 : i;
+    char *out = &st->output_str[st->sprite_can.len + (first - 1) * st->grid_cell];
+    for (size_t j = first; j <= i + 2; j++) {
+        TGStrView sv = st->arena.data[j];
+        memcpy(out, sv.str, sv.len);
+        out += sv.len;
+    }
+}
+
 /**
  * In order to properly set frame we need to know few things beforehand:
  *  -# element_index for TrashGuyState::text[element_index] we're currently working on
@@ -543,6 +1100,11 @@ unsigned tguy_set_frame(TrashGuyState *restrict st, unsigned frame) {
                  t = (b * b) + (4 * c);
         element_index = ((unsigned)sqrt(t) - b) / 2;
     }
+    if (st->lazy_src_ != NULL) {
+        /* element we work on and everything to the left of it must be segmented */
+        if (tguy_lazy_segment(st, (size_t)element_index + 1) != 0) return -1u;
+        if (frame >= st->max_frames) return -1u;
+    }
 
     /* number of frames needed to process element, see 2 */
     unsigned frames_per_element = first_element_frames_count + (2 * element_index);
@@ -577,12 +1139,20 @@ unsigned tguy_set_frame(TrashGuyState *restrict st, unsigned frame) {
     if (!right && i != 0) {
         st->arena.data[i] = st->text.data[element_index];
     }
+    if (st->grid_valid) {
+        if (prev_frame == frame - 1) {
+            grid_patch(st, i);
+        } else {
+            st->grid_valid = 0;
+        }
+    }
     return frame;
 }
 
 unsigned tguy_set_pos(TrashGuyState *st, unsigned sprite_pos, unsigned facing_right, unsigned element_index) {
     /* We can't be in place of trash can sprite, and we can't be in place of last arena tile */
     /* last frame is the final one so pos can't be anything other than 1 facing right */
+    if (st->lazy_src_ != NULL && tguy_lazy_segment(st, (size_t)element_index + 1) != 0) return -1u;
     if (sprite_pos == 0 || sprite_pos > st->arena.len - 1 || element_index > st->text.len) return -1u;
 
     if (element_index == st->text.len && (sprite_pos != 1 || !facing_right)) return -1u;
@@ -605,9 +1175,36 @@ void tguy_get_frame_state(const TrashGuyState *st, unsigned *frame, unsigned *sp
     if (element_index) *element_index = st->element_index;
 }
 
+int tguy_set_clear_mode(TrashGuyState *st, TGuyClearMode mode) {
+    if (mode == TGUY_CLEAR_SHADOW) {
+        if (st->lazy_src_ != NULL) return -1;
+        if (st->empty_arena_ == NULL) {
+            /* shadow has the same size as arena, it's only filled with spaces and trash can sprite as first element */
+            TGStrView *shadow = malloc(sizeof(shadow[0]) * st->arena.len);
+            if (shadow == NULL) return -1;
+            shadow[0] = st->sprite_can;
+            for (size_t i = 1, flen = st->arena.len; i < flen; i++) shadow[i] = st->sprite_space;
+            st->empty_arena_ = shadow;
+        }
+    } else if (mode == TGUY_CLEAR_AUTO || mode == TGUY_CLEAR_LOOP || mode == TGUY_CLEAR_FILL) {
+        free(st->empty_arena_);
+        st->empty_arena_ = NULL;
+    } else {
+        return -1;
+    }
+    st->clear_mode_ = mode;
+    return 0;
+}
+
+/* length of any frame in grid mode */
+static size_t grid_len(const TrashGuyState *st) {
+    return st->sprite_can.len + st->sprite_right.len + (st->arena.len - 2) * st->grid_cell;
+}
+
 size_t tguy_fprint(const TrashGuyState *st, FILE *fp) {
     assert(st->cur_frame != -1u);
     size_t len = 0;
+    if (st->grid_valid) return fwrite(st->output_str, 1, grid_len(st), fp);
     for (size_t i = 0, flen = st->arena.len; i < flen; i++) {
         TGStrView sv = st->arena.data[i];
         len += fwrite(sv.str, 1, sv.len, fp);
@@ -620,6 +1217,11 @@ size_t tguy_print(const TrashGuyState *st) { return tguy_fprint(st, stdout); }
 size_t tguy_sprint(const TrashGuyState *st, char *buf) {
     assert(st->cur_frame != (unsigned) -1);
     char *start = buf;
+    if (st->grid_valid) {
+        size_t len = grid_len(st);
+        memcpy(buf, st->output_str, len + 1);
+        return len;
+    }
     for (size_t i = 0, flen = st->arena.len; i < flen; i++) {
         TGStrView sv = st->arena.data[i];
         for (size_t j = 0, slen = sv.len; j < slen; j++) { *buf++ = sv.str[j]; }
@@ -634,7 +1236,15 @@ const TGStrView *tguy_get_arr(const TrashGuyState *st, size_t *len) {
     return st->arena.data;
 }
 
-unsigned tguy_get_frames_count(const TrashGuyState *st) { return st->max_frames; }
+unsigned tguy_get_frames_count(const TrashGuyState *st) {
+    /* -1 for lazy state until it's segmented completely */
+    return st->max_frames;
+}
+
+int tguy_segment_all(TrashGuyState *st) {
+    if (st->lazy_src_ == NULL) return 0;
+    return tguy_lazy_segment(st, (size_t)-1);
+}
 
 #define tg_max(a, b) ((a) > (b) ? (a) : (b))
 
@@ -652,6 +1262,13 @@ size_t tguy_get_bsize(TrashGuyState *st) {
          * by choosing the largest ensure the buffer is big enough */
         sz += tg_max(st->text.data[i].len, st->sprite_space.len);
     }
+    if (st->lazy_src_ != NULL && st->lazy_seg_ < st->lazy_len_) {
+        /* unsegmented rest of lazy text has at most one element per byte, each one at least 1 byte large:
+         * sum(max(len, space_len)) <= sum(len * max(1, space_len)), which holds as more of it gets segmented */
+        size_t rest_len = st->text.data[st->text.len - 1].len;
+        sz -= tg_max(rest_len, st->sprite_space.len);
+        sz += rest_len * tg_max(st->sprite_space.len, 1);
+    }
     /* overall free space length */
     sz += st->sprite_space.len * ((st->first_element_frames_count / 2) - 1);
     sz += st->sprite_can.len;
@@ -661,8 +1278,59 @@ size_t tguy_get_bsize(TrashGuyState *st) {
     return sz;
 }
 
+size_t tguy_get_window_bsize(TrashGuyState *st, size_t n_cells) {
+    size_t bsize = tguy_get_bsize(st);
+    if (st->cell_size == 0) {
+        size_t sz = tg_max(tg_max(st->sprite_right.len, st->sprite_left.len),
+                           tg_max(st->sprite_can.len, st->sprite_space.len));
+        /* unsegmented rest of lazy text is the last element, no element split from it can be larger */
+        for (size_t i = 0, tlen = st->text.len; i < tlen; i++) sz = tg_max(sz, st->text.data[i].len);
+        /* empty cells are still 1 byte at most, keeps the result non-zero */
+        sz = tg_max(sz, 1);
+        /* bound shrinks as more of lazy text gets segmented */
+        if (st->lazy_src_ != NULL && st->lazy_seg_ < st->lazy_len_) {
+            return (n_cells < (bsize - 1) / sz) ? n_cells * sz + 1 : bsize;
+        }
+        st->cell_size = sz;
+    }
+    /* window is never larger than the whole frame */
+    return (n_cells < (bsize - 1) / st->cell_size) ? n_cells * st->cell_size + 1 : bsize;
+}
+
 #undef tg_max
 
+size_t tguy_sprint_window(TrashGuyState *st, size_t first_cell, size_t n_cells, char buf[]) {
+    assert(st->cur_frame != (unsigned) -1);
+    size_t items_offset = st->arena.len - st->text.len;
+    size_t end;
+    char *start = buf;
+
+    if (first_cell == TGUY_WINDOW_FOLLOW) {
+        /* keep TrashGuy in the middle of the window */
+        first_cell = (st->pos > n_cells / 2) ? st->pos - n_cells / 2 : 0;
+    }
+    end = (n_cells > (size_t)-1 - first_cell) ? (size_t)-1 : first_cell + n_cells;
+    if (st->lazy_src_ != NULL && st->lazy_seg_ < st->lazy_len_ && end > items_offset) {
+        /* window must not end up inside the unsegmented rest of lazy text, it's a single cell */
+        if (tguy_lazy_segment(st, end - items_offset) != 0) {
+            *buf = '\0';
+            return 0;
+        }
+    }
+    if (end > st->arena.len) {
+        /* window past the end shows the last cells instead */
+        end = st->arena.len;
+        first_cell = (n_cells < end) ? end - n_cells : 0;
+    }
+    for (size_t i = first_cell; i < end; i++) {
+        TGStrView sv = st->arena.data[i];
+        memcpy(buf, sv.str, sv.len);
+        buf += sv.len;
+    }
+    *buf = '\0';
+    return (size_t)(buf - start);
+}
+
 const char *tguy_get_string(TrashGuyState *st, size_t *len) {
     size_t plen;
     if (st->output_str == NULL) {
@@ -670,8 +1338,12 @@ const char *tguy_get_string(TrashGuyState *st, size_t *len) {
     }
     if (st->output_str == NULL) {
         plen = 0;
+    } else if (st->grid_valid) {
+        /* already patched by tguy_set_frame() */
+        plen = grid_len(st);
     } else {
         plen = tguy_sprint(st, st->output_str);
+        st->grid_valid = (st->grid_cell != 0);
     }
     if (len != NULL) *len = plen;
     return st->output_str;
@@ -681,6 +1353,752 @@ unsigned tguy_get_first_frame_for_element(const TrashGuyState *st, unsigned elem
     return get_first_frame_for_element(st->first_element_frames_count, element_index);
 }
 
+/**
+ *  Decodes one codepoint, anything that isn't a valid utf-8 sequence decodes as U+FFFD one byte at a time
+ * @param[out] cp  decoded codepoint
+ * @return         number of bytes consumed, >= 1
+ */
+static size_t utf8_decode(const unsigned char *s, size_t len, uint32_t *cp) {
+    size_t n;
+    uint32_t c = s[0];
+    /* smallest codepoint for sequence of n bytes, rejects overlong forms */
+    static const uint32_t min_cp[] = {0, 0, 0x80, 0x800, 0x10000};
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    }
+    if ((c & 0xE0) == 0xC0) {
+        n = 2;
+        c &= 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+        n = 3;
+        c &= 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+        n = 4;
+        c &= 0x07;
+    } else {
+        n = 0;
+    }
+    if (n == 0 || n > len) goto invalid;
+    for (size_t i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) goto invalid;
+        c = (c << 6) | (s[i] & 0x3F);
+    }
+    if (c < min_cp[n] || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) goto invalid;
+    *cp = c;
+    return n;
+invalid:
+    *cp = 0xFFFD;
+    return 1;
+}
+
+/**
+ *  Transcodes utf-8 string to utf-16 or utf-32
+ * @param out   where to write code units or NULL to only count them
+ * @param usize size of code unit, 2 or 4
+ * @return      number of code units
+ */
+static size_t utf8_transcode(const TGStrView *sv, size_t usize, unsigned char *out) {
+    const unsigned char *s = (const unsigned char *)sv->str;
+    size_t n = 0;
+    for (size_t i = 0; i < sv->len;) {
+        uint32_t cp;
+        i += utf8_decode(&s[i], sv->len - i, &cp);
+        if (usize == 4) {
+            if (out) memcpy(&out[n * 4], &cp, 4);
+            n++;
+        } else if (cp < 0x10000) {
+            uint16_t u = (uint16_t)cp;
+            if (out) memcpy(&out[n * 2], &u, 2);
+            n++;
+        } else {
+            uint16_t u[2];
+            cp -= 0x10000;
+            u[0] = (uint16_t)(0xD800 | (cp >> 10));
+            u[1] = (uint16_t)(0xDC00 | (cp & 0x3FF));
+            if (out) memcpy(&out[n * 2], u, 4);
+            n += 2;
+        }
+    }
+    return n;
+}
+
+/* number of code units in string k of TGuyWideCache */
+static inline size_t wide_len(const TGuyWideCache *wc, size_t k) {
+    return wc->ends[k] - (k ? wc->ends[k - 1] : 0);
+}
+
+#define tg_max(a, b) ((a) > (b) ? (a) : (b))
+
+/**
+ *  Transcodes every element and sprite of TrashGuyState once, lazy state gets segmented completely
+ * @param st    Valid TrashGuyState
+ * @param usize size of code unit, 2 or 4
+ * @return      TGuyWideCache to be freed with free() or NULL on allocation failure
+ */
+static TGuyWideCache *wide_cache_new(TrashGuyState *st, size_t usize) {
+    const TGStrView *sprites[TGUY_WIDE_SPRITES] = {&st->sprite_right, &st->sprite_left, &st->sprite_can, &st->sprite_space};
+    TGuyWideCache *wc;
+    size_t n_strings, n_units = 0;
+    size_t n_text, space_len, sz = 1;
+
+    if (st->lazy_src_ != NULL) {
+        ignored_ tguy_lazy_segment(st, (size_t)-1);
+        if (st->lazy_seg_ < st->lazy_len_) return NULL;
+    }
+    n_strings = st->text.len + TGUY_WIDE_SPRITES;
+    for (size_t i = 0; i < n_strings; i++) {
+        const TGStrView *sv = (i < st->text.len) ? &st->text.data[i] : sprites[i - st->text.len];
+        n_units += utf8_transcode(sv, usize, NULL);
+    }
+    /* units are aligned to size_t */
+    wc = malloc(sizeof(*wc) + sizeof(wc->ends[0]) * n_strings + n_units * usize);
+    if (wc == NULL) return NULL;
+    wc->ends = (size_t *)(wc + 1);
+    wc->units = (unsigned char *)&wc->ends[n_strings];
+
+    n_units = 0;
+    for (size_t i = 0; i < n_strings; i++) {
+        const TGStrView *sv = (i < st->text.len) ? &st->text.data[i] : sprites[i - st->text.len];
+        n_units += utf8_transcode(sv, usize, &wc->units[n_units * usize]);
+        wc->ends[i] = n_units;
+    }
+
+    /* same as tguy_get_bsize(), see it for details */
+    n_text = st->text.len;
+    space_len = wide_len(wc, n_text + TGUY_WIDE_SPACE);
+    for (size_t i = 0; i < n_text; i++) sz += tg_max(wide_len(wc, i), space_len);
+    sz += space_len * ((st->first_element_frames_count / 2) - 1);
+    sz += wide_len(wc, n_text + TGUY_WIDE_CAN);
+    sz += tg_max(wide_len(wc, n_text + TGUY_WIDE_RIGHT), wide_len(wc, n_text + TGUY_WIDE_LEFT));
+    wc->buf_size = sz;
+    return wc;
+}
+
+#undef tg_max
+
+/**
+ *  Renders currently set frame from TGuyWideCache. Cells are reconstructed from the frame state the same way
+ *  tguy_set_frame() lays out the arena: trash can, spaces with TrashGuy and the element it carries,
+ *  then elements that aren't processed yet, which are contiguous in the cache and are copied at once
+ * @param usize size of code unit, 2 or 4
+ * @return      number of code units written, excluding the nul terminator
+ */
+static size_t wide_sprint(const TrashGuyState *st, const TGuyWideCache *wc, size_t usize, unsigned char *buf) {
+    size_t n_text = st->text.len;
+    size_t items_offset = st->arena.len - n_text;
+    size_t n_clear = st->element_index + !st->facing_right;
+    size_t n = 0;
+
+    /* copies string k of the cache, k < n_text is an element */
+#define wide_put(k) do { \
+        size_t k_ = (k), len_ = wide_len(wc, k_); \
+        memcpy(&buf[n * usize], &wc->units[(wc->ends[k_] - len_) * usize], len_ * usize); \
+        n += len_; \
+    } while (0)
+
+    wide_put(n_text + TGUY_WIDE_CAN);
+    for (size_t j = 1; j < items_offset + n_clear; j++) {
+        if (j == st->pos) {
+            wide_put(n_text + (st->facing_right ? TGUY_WIDE_RIGHT : TGUY_WIDE_LEFT));
+        } else if (j == st->pos - 1 && !st->facing_right) {
+            wide_put(st->element_index);
+        } else {
+            wide_put(n_text + TGUY_WIDE_SPACE);
+        }
+    }
+    if (n_clear < n_text) {
+        size_t start = n_clear ? wc->ends[n_clear - 1] : 0;
+        memcpy(&buf[n * usize], &wc->units[start * usize], (wc->ends[n_text - 1] - start) * usize);
+        n += wc->ends[n_text - 1] - start;
+    }
+#undef wide_put
+    memset(&buf[n * usize], 0, usize);
+    return n;
+}
+
+size_t tguy_get_bsize_utf16(TrashGuyState *st) {
+    if (st->utf16_ == NULL) st->utf16_ = wide_cache_new(st, 2);
+    return st->utf16_ ? st->utf16_->buf_size : 0;
+}
+
+size_t tguy_get_bsize_utf32(TrashGuyState *st) {
+    if (st->utf32_ == NULL) st->utf32_ = wide_cache_new(st, 4);
+    return st->utf32_ ? st->utf32_->buf_size : 0;
+}
+
+size_t tguy_sprint_utf16(const TrashGuyState *st, uint16_t buf[]) {
+    assert(st->cur_frame != (unsigned) -1);
+    /* cache is built by tguy_get_bsize_utf16() */
+    if (st->utf16_ == NULL) return 0;
+    return wide_sprint(st, st->utf16_, 2, (unsigned char *)buf);
+}
+
+size_t tguy_sprint_utf32(const TrashGuyState *st, uint32_t buf[]) {
+    assert(st->cur_frame != (unsigned) -1);
+    if (st->utf32_ == NULL) return 0;
+    return wide_sprint(st, st->utf32_, 4, (unsigned char *)buf);
+}
+
+/** Timing wheel size of TGuyPlayer, power of 2 */
+#define TGUY_WHEEL_SLOTS 512u
+/** Marks the end of TGuyPlayerSession lists */
+#define TGUY_NIL ((size_t)-1)
+
+/**
+ * Animation played by TGuyPlayer, linked into the wheel slot of its deadline or into the free list
+ */
+typedef struct {
+    TrashGuyState *st; /**< state to render, NULL if session is free */
+    TGuyWriteFn write; /**< consumer callback */
+    void *userdata; /**< passed to write */
+    char *buf; /**< rendered frame, tguy_get_bsize() bytes, allocated on the first render */
+    size_t buf_len; /**< length of rendered frame */
+    size_t buf_off; /**< number of bytes of buf already consumed */
+    uint64_t deadline; /**< when next frame is due */
+    unsigned interval; /**< time between frames */
+    unsigned next_frame; /**< frame to render at deadline */
+    size_t prev, next; /**< neighbours in the slot list */
+    TGuyPlayerStats stats; /**< metrics reported by tguy_player_get_stats() */
+} TGuyPlayerSession;
+
+/**
+ * Hashed timing wheel of sessions, session with deadline d lives in slot (d / tick) % TGUY_WHEEL_SLOTS.
+ * Slots are checked tick by tick, deadlines which are whole wheel turns ahead stay in the slot until they're due
+ */
+struct TGuyPlayer {
+    TGuyPlayerSession *sessions; /**< sessions indexed by id */
+    size_t n_sessions; /**< number of used entries in sessions, including free ones */
+    size_t cap_sessions; /**< capacity of sessions */
+    size_t free_head; /**< list of free sessions chained via TGuyPlayerSession::next */
+    unsigned tick; /**< wheel granularity */
+    uint64_t cur_tick; /**< last tick processed by tguy_player_advance() */
+    size_t slots[TGUY_WHEEL_SLOTS]; /**< heads of session lists */
+};
+
+static size_t player_slot(const TGuyPlayer *p, uint64_t deadline) {
+    return (size_t)((deadline / p->tick) & (TGUY_WHEEL_SLOTS - 1));
+}
+
+static void player_link(TGuyPlayer *p, size_t id) {
+    TGuyPlayerSession *s = &p->sessions[id];
+    size_t slot = player_slot(p, s->deadline);
+    s->prev = TGUY_NIL;
+    s->next = p->slots[slot];
+    if (s->next != TGUY_NIL) p->sessions[s->next].prev = id;
+    p->slots[slot] = id;
+}
+
+static void player_unlink(TGuyPlayer *p, size_t id) {
+    TGuyPlayerSession *s = &p->sessions[id];
+    if (s->prev != TGUY_NIL) {
+        p->sessions[s->prev].next = s->next;
+    } else {
+        p->slots[player_slot(p, s->deadline)] = s->next;
+    }
+    if (s->next != TGUY_NIL) p->sessions[s->next].prev = s->prev;
+}
+
+/* returns session to the free list, session must be unlinked */
+static void player_release(TGuyPlayer *p, size_t id) {
+    TGuyPlayerSession *s = &p->sessions[id];
+    free(s->buf);
+    s->buf = NULL;
+    s->st = NULL;
+    s->next = p->free_head;
+    p->free_head = id;
+}
+
+TGuyPlayer *tguy_player_new(unsigned tick, uint64_t now) {
+    TGuyPlayer *p = malloc(sizeof(*p));
+    if (p == NULL) return NULL;
+    p->sessions = NULL;
+    p->n_sessions = 0;
+    p->cap_sessions = 0;
+    p->free_head = TGUY_NIL;
+    p->tick = tick ? tick : 1;
+    p->cur_tick = now / p->tick;
+    for (size_t i = 0; i < TGUY_WHEEL_SLOTS; i++) p->slots[i] = TGUY_NIL;
+    return p;
+}
+
+void tguy_player_free(TGuyPlayer *p) {
+    if (p == NULL) return;
+    for (size_t i = 0; i < p->n_sessions; i++) free(p->sessions[i].buf);
+    free(p->sessions);
+    free(p);
+}
+
+size_t tguy_player_add(TGuyPlayer *p, TrashGuyState *st, unsigned interval, TGuyWriteFn write, void *userdata) {
+    size_t id;
+    TGuyPlayerSession *s;
+    if (p->free_head != TGUY_NIL) {
+        id = p->free_head;
+        p->free_head = p->sessions[id].next;
+    } else {
+        if (p->n_sessions == p->cap_sessions) {
+            size_t cap = p->cap_sessions ? p->cap_sessions * 2 : 16;
+            TGuyPlayerSession *sessions = realloc(p->sessions, sizeof(sessions[0]) * cap);
+            if (sessions == NULL) return TGUY_NIL;
+            p->sessions = sessions;
+            p->cap_sessions = cap;
+        }
+        id = p->n_sessions++;
+    }
+    s = &p->sessions[id];
+    s->st = st;
+    s->write = write;
+    s->userdata = userdata;
+    s->buf = NULL;
+    s->buf_len = 0;
+    s->buf_off = 0;
+    s->interval = interval ? interval : 1;
+    s->next_frame = 0;
+    /* due right away */
+    s->deadline = p->cur_tick * p->tick;
+    s->stats = (TGuyPlayerStats){(unsigned)-1, 0, 0, 0, 0, 0};
+    player_link(p, id);
+    return id;
+}
+
+static int player_valid_id(const TGuyPlayer *p, size_t id) {
+    return id < p->n_sessions && p->sessions[id].st != NULL;
+}
+
+int tguy_player_remove(TGuyPlayer *p, size_t id) {
+    if (!player_valid_id(p, id)) return -1;
+    player_unlink(p, id);
+    player_release(p, id);
+    return 0;
+}
+
+/* hands the rest of the buffer to the consumer, returns 1 if whole frame is consumed, 0 if not, -1 if closed */
+static int player_flush(TGuyPlayerSession *s) {
+    size_t n = s->write(s->userdata, s->buf + s->buf_off, s->buf_len - s->buf_off);
+    if (n == (size_t)-1) return -1;
+    s->buf_off += n;
+    s->stats.backlog = s->buf_len - s->buf_off;
+    if (s->buf_off < s->buf_len) return 0;
+    s->stats.frames_written++;
+    return 1;
+}
+
+/**
+ *  Services one due session
+ * @param[out] finished Set to 1 if session is over and must be released, 0 otherwise
+ * @return 1 if frame was rendered, 0 if not
+ */
+static int player_service(TGuyPlayerSession *s, uint64_t now, int *finished) {
+    /* -1 for lazy state until tguy_set_frame() gets to its end */
+    unsigned max_frames = tguy_get_frames_count(s->st);
+    int rendered = 0;
+    int flushed = (s->buf_off < s->buf_len) ? player_flush(s) : 1;
+    /* failures below end the session */
+    *finished = 1;
+    if (flushed < 0) return 0;
+
+    if (s->next_frame < max_frames) {
+        /* frames missed entirely while player was late */
+        uint64_t missed = (now - s->deadline) / s->interval;
+        if (missed > max_frames - 1 - s->next_frame) missed = max_frames - 1 - s->next_frame;
+        s->next_frame += (unsigned)missed;
+        s->stats.frames_dropped += (unsigned)missed;
+        s->deadline += (missed + 1) * s->interval;
+
+        if (!flushed) {
+            /* consumer is still busy with the previous frame, skip this one, the last one is retried instead */
+            if (s->next_frame < max_frames - 1) {
+                s->stats.frames_dropped++;
+                s->next_frame++;
+            }
+            *finished = 0;
+            return 0;
+        }
+        if (s->buf == NULL) {
+            s->buf = malloc(tguy_get_bsize(s->st));
+            if (s->buf == NULL) return 0;
+        }
+        if (tguy_set_frame(s->st, s->next_frame) == -1u) {
+            /* lazy state segmented up to its end, frames skipped past it fall back to the last one */
+            max_frames = tguy_get_frames_count(s->st);
+            if (s->next_frame < max_frames) return 0;
+            s->stats.frames_dropped -= s->next_frame - (max_frames - 1);
+            s->next_frame = max_frames - 1;
+            if (tguy_set_frame(s->st, s->next_frame) == -1u) return 0;
+        }
+        s->buf_len = tguy_sprint(s->st, s->buf);
+        s->buf_off = 0;
+        s->stats.frame = s->next_frame++;
+        s->stats.last_latency = now - (s->deadline - s->interval);
+        if (s->stats.last_latency > s->stats.max_latency) s->stats.max_latency = s->stats.last_latency;
+        rendered = 1;
+        flushed = player_flush(s);
+        /* frame was rendered even if consumer closed right away */
+        if (flushed < 0) return rendered;
+    } else {
+        s->deadline += s->interval;
+    }
+    *finished = (s->next_frame >= tguy_get_frames_count(s->st) && flushed);
+    return rendered;
+}
+
+size_t tguy_player_advance(TGuyPlayer *p, uint64_t now) {
+    uint64_t now_tick = now / p->tick;
+    /* after a full turn every slot was visited, later ticks would only revisit the same slots */
+    uint64_t last_tick = (now_tick - p->cur_tick >= TGUY_WHEEL_SLOTS) ? p->cur_tick + TGUY_WHEEL_SLOTS - 1 : now_tick;
+    size_t n_rendered = 0;
+    size_t due = TGUY_NIL;
+
+    if (now_tick < p->cur_tick) return 0;
+    /* collect due sessions first, so rescheduled ones aren't visited twice */
+    for (uint64_t t = p->cur_tick; t <= last_tick; t++) {
+        size_t id = p->slots[t & (TGUY_WHEEL_SLOTS - 1)];
+        while (id != TGUY_NIL) {
+            size_t next = p->sessions[id].next;
+            if (p->sessions[id].deadline <= now) {
+                player_unlink(p, id);
+                p->sessions[id].next = due;
+                due = id;
+            }
+            id = next;
+        }
+    }
+    p->cur_tick = now_tick;
+
+    while (due != TGUY_NIL) {
+        TGuyPlayerSession *s = &p->sessions[due];
+        size_t next = s->next;
+        int finished;
+        /* last frame of a session is counted before the session is retired */
+        n_rendered += (size_t)player_service(s, now, &finished);
+        if (finished) {
+            s->write(s->userdata, NULL, 0);
+            player_release(p, due);
+        } else {
+            /* late session may still be behind, slots before cur_tick won't be visited until the wheel turns */
+            if (s->deadline <= now) s->deadline = (now_tick + 1) * p->tick;
+            player_link(p, due);
+        }
+        due = next;
+    }
+    return n_rendered;
+}
+
+uint64_t tguy_player_next_deadline(const TGuyPlayer *p) {
+    uint64_t best = UINT64_MAX;
+    for (uint64_t t = p->cur_tick; t < p->cur_tick + TGUY_WHEEL_SLOTS; t++) {
+        /* deadlines of this turn are sorted by slot, so the first one found within its own tick is the earliest */
+        uint64_t tick_end = (t + 1) * p->tick;
+        for (size_t id = p->slots[t & (TGUY_WHEEL_SLOTS - 1)]; id != TGUY_NIL; id = p->sessions[id].next) {
+            uint64_t deadline = p->sessions[id].deadline;
+            if (deadline < best) best = deadline;
+        }
+        if (best < tick_end) return best;
+    }
+    return best;
+}
+
+int tguy_player_get_stats(const TGuyPlayer *p, size_t id, TGuyPlayerStats *stats) {
+    if (!player_valid_id(p, id)) return -1;
+    *stats = p->sessions[id].stats;
+    return 0;
+}
+
+#undef TGUY_NIL
+#undef TGUY_WHEEL_SLOTS
+
+/**
+ * State drawn by TGuyCompositor
+ */
+typedef struct {
+    TrashGuyState *st; /**< state to draw, NULL if entry is free */
+    unsigned row; /**< screen row */
+    unsigned drawn_frame; /**< frame that was drawn last, -1 (UINT_MAX) if none */
+    size_t next_free; /**< next entry in the free list */
+} TGuyCompositorEntry;
+
+/**
+ * Set of states sharing one screen buffer
+ */
+struct TGuyCompositor {
+    TGuyCompositorEntry *entries; /**< entries indexed by id */
+    size_t n_entries; /**< number of used entries, including free ones */
+    size_t cap_entries; /**< capacity of entries */
+    size_t free_head; /**< list of free entries, -1 if empty */
+    char *screen; /**< output buffer */
+    size_t screen_cap; /**< size of output buffer */
+};
+
+/** "\x1b[" + row + ";1H" and "\x1b[K" with row of at most 10 digits */
+#define TGUY_ROW_ESC_LEN 20
+
+TGuyCompositor *tguy_compositor_new(void) {
+    TGuyCompositor *c = malloc(sizeof(*c));
+    if (c == NULL) return NULL;
+    c->entries = NULL;
+    c->n_entries = 0;
+    c->cap_entries = 0;
+    c->free_head = (size_t)-1;
+    c->screen = NULL;
+    c->screen_cap = 0;
+    return c;
+}
+
+void tguy_compositor_free(TGuyCompositor *c) {
+    if (c == NULL) return;
+    free(c->entries);
+    free(c->screen);
+    free(c);
+}
+
+size_t tguy_compositor_add(TGuyCompositor *c, TrashGuyState *st, unsigned row) {
+    size_t id;
+    if (c->free_head != (size_t)-1) {
+        id = c->free_head;
+        c->free_head = c->entries[id].next_free;
+    } else {
+        if (c->n_entries == c->cap_entries) {
+            size_t cap = c->cap_entries ? c->cap_entries * 2 : 16;
+            TGuyCompositorEntry *entries = realloc(c->entries, sizeof(entries[0]) * cap);
+            if (entries == NULL) return (size_t)-1;
+            c->entries = entries;
+            c->cap_entries = cap;
+        }
+        id = c->n_entries++;
+    }
+    c->entries[id] = (TGuyCompositorEntry){st, row, (unsigned)-1, (size_t)-1};
+    return id;
+}
+
+int tguy_compositor_remove(TGuyCompositor *c, size_t id) {
+    if (id >= c->n_entries || c->entries[id].st == NULL) return -1;
+    c->entries[id].st = NULL;
+    c->entries[id].next_free = c->free_head;
+    c->free_head = id;
+    return 0;
+}
+
+size_t tguy_compositor_tick(TGuyCompositor *c) {
+    size_t n_playing = 0;
+    for (size_t i = 0; i < c->n_entries; i++) {
+        TrashGuyState *st = c->entries[i].st;
+        unsigned frame;
+        if (st == NULL) continue;
+        tguy_get_frame_state(st, &frame, NULL, NULL, NULL);
+        if (frame + 1 < tguy_get_frames_count(st)) {
+            /* sequential frame, only touches few arena cells */
+            tguy_set_frame(st, ++frame);
+            n_playing += (frame + 1 < tguy_get_frames_count(st));
+        }
+    }
+    return n_playing;
+}
+
+const char *tguy_compositor_render(TGuyCompositor *c, size_t *len) {
+    size_t need = 1, plen = 0;
+    /* size the buffer for the worst case first, so rows are written in a single pass */
+    for (size_t i = 0; i < c->n_entries; i++) {
+        TGuyCompositorEntry *e = &c->entries[i];
+        if (e->st == NULL || e->st->cur_frame == e->drawn_frame) continue;
+        need += TGUY_ROW_ESC_LEN + tguy_get_bsize(e->st);
+    }
+    if (need > c->screen_cap) {
+        char *screen = realloc(c->screen, need);
+        if (screen == NULL) {
+            if (len != NULL) *len = 0;
+            return NULL;
+        }
+        c->screen = screen;
+        c->screen_cap = need;
+    }
+    for (size_t i = 0; i < c->n_entries; i++) {
+        TGuyCompositorEntry *e = &c->entries[i];
+        if (e->st == NULL || e->st->cur_frame == e->drawn_frame) continue;
+        plen += (size_t)sprintf(&c->screen[plen], "\x1b[%u;1H", e->row + 1);
+        plen += tguy_sprint(e->st, &c->screen[plen]);
+        memcpy(&c->screen[plen], "\x1b[K", 3);
+        plen += 3;
+        e->drawn_frame = e->st->cur_frame;
+    }
+    c->screen[plen] = '\0';
+    if (len != NULL) *len = plen;
+    return c->screen;
+}
+
+#undef TGUY_ROW_ESC_LEN
+
+#if defined __GNUC__ || defined __clang__
+#define TGUY_HAVE_ATOMICS
+#define tg_load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define tg_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define tg_load_relaxed(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define tg_store_relaxed(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#elif defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+/* x86 loads and stores are acquire and release already, only the compiler has to be kept from reordering them */
+#include <intrin.h>
+#define TGUY_HAVE_ATOMICS
+#define tg_load_acquire(p) tg_msvc_load_(*(volatile size_t *)(p))
+#define tg_store_release(p, v) (_ReadWriteBarrier(), *(volatile size_t *)(p) = (v))
+#define tg_load_relaxed(p) (*(volatile size_t *)(p))
+#define tg_store_relaxed(p, v) (*(volatile size_t *)(p) = (v))
+static __forceinline size_t tg_msvc_load_(size_t v) {
+    _ReadWriteBarrier();
+    return v;
+}
+#endif
+
+/** Size of a cache line, keeps producer and consumer fields of TGuyRing apart */
+#define TGUY_CACHE_LINE 64
+
+/**
+ * Rendered frame in TGuyRing
+ */
+typedef struct {
+    char *buf; /**< nul-terminated frame, tguy_get_bsize() bytes large */
+    size_t len; /**< length of the frame in bytes */
+    size_t gen; /**< TGuyRing::seek_gen the frame was rendered for */
+    unsigned frame; /**< frame index */
+} TGuyRingSlot;
+
+/**
+ * Single-producer single-consumer ring of rendered frames. Slots [head, tail) are ready,
+ * head is only written by the consumer and tail only by the producer
+ */
+struct TGuyRing {
+    TrashGuyState *st; /**< state only the producer touches */
+    TGuyRingSlot *slots; /**< slots, buffers are allocated together with them */
+    size_t n_slots; /**< number of slots */
+    char pad0_[TGUY_CACHE_LINE];
+    /* producer */
+    size_t tail; /**< number of slots published so far */
+    size_t prod_gen; /**< last seek_gen seen by the producer */
+    unsigned next_frame; /**< frame to render next */
+    char pad1_[TGUY_CACHE_LINE];
+    /* consumer */
+    size_t head; /**< number of slots consumed so far */
+    size_t cons_gen; /**< last seek_gen set by the consumer */
+    char pad2_[TGUY_CACHE_LINE];
+    /* consumer to producer */
+    size_t seek_gen; /**< incremented by every tguy_ring_seek() */
+    size_t seek_frame; /**< frame of the last seek */
+};
+
+TGuyRing *tguy_ring_new(TrashGuyState *st, size_t n_slots) {
+#ifdef TGUY_HAVE_ATOMICS
+    TGuyRing *r;
+    size_t bsize = tguy_get_bsize(st);
+    char *bufs;
+    if (n_slots == 0 || n_slots > ((size_t)-1 - sizeof(TGuyRingSlot)) / (sizeof(TGuyRingSlot) + bsize)) return NULL;
+    r = malloc(sizeof(*r));
+    if (r == NULL) return NULL;
+    r->slots = malloc((sizeof(r->slots[0]) + bsize) * n_slots);
+    if (r->slots == NULL) {
+        free(r);
+        return NULL;
+    }
+    bufs = (char *)&r->slots[n_slots];
+    for (size_t i = 0; i < n_slots; i++) r->slots[i].buf = &bufs[i * bsize];
+    r->st = st;
+    r->n_slots = n_slots;
+    r->tail = 0;
+    r->prod_gen = 0;
+    r->next_frame = 0;
+    r->head = 0;
+    r->cons_gen = 0;
+    r->seek_gen = 0;
+    r->seek_frame = 0;
+    return r;
+#else
+    /* no atomics for this compiler */
+    (void)st;
+    (void)n_slots;
+    return NULL;
+#endif
+}
+
+void tguy_ring_free(TGuyRing *r) {
+    if (r == NULL) return;
+    free(r->slots);
+    free(r);
+}
+
+#ifdef TGUY_HAVE_ATOMICS
+
+int tguy_ring_produce(TGuyRing *r) {
+    size_t gen = tg_load_acquire(&r->seek_gen);
+    size_t tail = r->tail;
+    TGuyRingSlot *slot;
+
+    if (gen != r->prod_gen) {
+        /* seek_frame may already belong to a later seek, frames rendered for this one are dropped anyway */
+        r->prod_gen = gen;
+        r->next_frame = (unsigned)tg_load_relaxed(&r->seek_frame);
+    }
+    /* frame count of lazy state is unknown until tguy_set_frame() gets to its end */
+    if (r->next_frame >= tguy_get_frames_count(r->st)) return -1;
+    if (tail - tg_load_acquire(&r->head) == r->n_slots) return 0;
+
+    /* sequential frames take the cheap path of tguy_set_frame() */
+    if (tguy_set_frame(r->st, r->next_frame) == -1u) return -1;
+    slot = &r->slots[tail % r->n_slots];
+    slot->len = tguy_sprint(r->st, slot->buf);
+    slot->frame = r->next_frame;
+    slot->gen = gen;
+    tg_store_release(&r->tail, tail + 1);
+    r->next_frame++;
+    return 1;
+}
+
+const char *tguy_ring_acquire(TGuyRing *r, unsigned *frame, size_t *len) {
+    size_t head = r->head;
+    const TGuyRingSlot *slot;
+    while (1) {
+        if (head == tg_load_acquire(&r->tail)) return NULL;
+        slot = &r->slots[head % r->n_slots];
+        if (slot->gen == r->cons_gen) break;
+        /* rendered before the last seek */
+        tg_store_release(&r->head, ++head);
+    }
+    if (frame != NULL) *frame = slot->frame;
+    if (len != NULL) *len = slot->len;
+    return slot->buf;
+}
+
+void tguy_ring_release(TGuyRing *r) {
+    assert(r->head != tg_load_acquire(&r->tail));
+    tg_store_release(&r->head, r->head + 1);
+}
+
+void tguy_ring_seek(TGuyRing *r, unsigned frame) {
+    r->cons_gen++;
+    tg_store_relaxed(&r->seek_frame, (size_t)frame);
+    tg_store_release(&r->seek_gen, r->cons_gen);
+    /* drop what's ready now, slots published until the producer sees the seek are skipped by tguy_ring_acquire() */
+    tg_store_release(&r->head, tg_load_acquire(&r->tail));
+}
+
+#else
+
+int tguy_ring_produce(TGuyRing *r) { (void)r; return -1; }
+
+const char *tguy_ring_acquire(TGuyRing *r, unsigned *frame, size_t *len) {
+    (void)r;
+    (void)frame;
+    (void)len;
+    return NULL;
+}
+
+void tguy_ring_release(TGuyRing *r) { (void)r; }
+
+void tguy_ring_seek(TGuyRing *r, unsigned frame) {
+    (void)r;
+    (void)frame;
+}
+
+#endif
+
+#undef TGUY_CACHE_LINE
+
 unsigned tguy_get_version(void) {
     return 1000000 * TGUY_VER_MAJOR + 1000 * TGUY_VER_MINOR + TGUY_VER_PATCH;
 }
@@ -6,6 +6,7 @@
  */
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
 /** @defgroup VERSION Version macros
@@ -74,7 +75,8 @@ typedef struct TrashGuyState TrashGuyState;
  * @param sprite_right Sprite to be used when TrashGuy moves right
  * @param sprite_left  Sprite to be used when TrashGuy moves left
  * @param preserve_strings If set to false function won't make a copy of all strings in passed TGStrView
- *  and will instead rely on caller to preserve those strings until tguy_free is called
+ *  and will instead rely on caller to preserve those strings until tguy_free is called.
+ *  Sprites are copied in either case, so they only have to live until the function returns
  * @return             TrashGuyState * or NULL on allocation failure, must be freed with tguy_free() after use
  */
 LIBTGUY_EXPORT TrashGuyState *tguy_from_arr_ex_2(const TGStrView *arr, size_t len, unsigned spacing,
@@ -104,6 +106,30 @@ LIBTGUY_EXPORT TrashGuyState *tguy_from_arr_ex(const TGStrView *arr, size_t len,
  */
 LIBTGUY_EXPORT TrashGuyState *tguy_from_arr(const TGStrView *arr, size_t len, unsigned spacing);
 
+/**
+ *  Creates new TrashGuysState from a utf-8 string, where each grapheme cluster is made into an element to dump
+ * @param string            Valid utf-8 string, in case of NULL, acts like empty string and len is set as 0
+ * @param len               Number of bytes string has, if -1, then strlen will be used
+ * @param spacing           Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @param sprite_space      Sprite to be used as empty space
+ * @param sprite_space_len  Number of bytes for sprite_space
+ * @param sprite_can        Sprite to be used as trash can
+ * @param sprite_can_len    Number of bytes for sprite_can
+ * @param sprite_right      Sprite to be used when TrashGuy moves right
+ * @param sprite_right_len  Number of bytes for sprite_right
+ * @param sprite_left       Sprite to be used when TrashGuy moves left
+ * @param sprite_left_len   Number of bytes for sprite_left
+ * @param preserve_strings  If set to false function won't copy the string, elements will point into it
+ *  and caller must preserve it until tguy_free is called
+ * @return TrashGuyState * or NULL on allocation failure, must be freed with tguy_free() after use
+ */
+LIBTGUY_EXPORT TrashGuyState *tguy_from_utf8_ex_2(const char *string, size_t len, unsigned spacing,
+    const char *sprite_space, size_t sprite_space_len,
+    const char *sprite_can, size_t sprite_can_len,
+    const char *sprite_right, size_t sprite_right_len,
+    const char *sprite_left, size_t sprite_left_len,
+    int preserve_strings);
+
 /**
  *  Creates new TrashGuysState from a utf-8 string, where each grapheme cluster is made into an element to dump
  * @param string            Valid utf-8 string, in case of NULL, acts like empty string and len is set as 0
@@ -134,6 +160,166 @@ LIBTGUY_EXPORT TrashGuyState *tguy_from_utf8_ex(const char *string, size_t len,
  */
 LIBTGUY_EXPORT TrashGuyState *tguy_from_utf8(const char string[], size_t len, unsigned spacing);
 
+/** @typedef TGuyBuilder
+ *  Anonymous struct typedef for incremental construction of TrashGuyState from utf-8 text received in chunks
+ */
+typedef struct TGuyBuilder TGuyBuilder;
+
+/**
+ *  Creates new TGuyBuilder. If pointer to sprite is NULL then default one will be used, sprites are copied
+ * @param spacing           Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @param sprite_space      Sprite to be used as empty space
+ * @param sprite_space_len  Number of bytes for sprite_space
+ * @param sprite_can        Sprite to be used as trash can
+ * @param sprite_can_len    Number of bytes for sprite_can
+ * @param sprite_right      Sprite to be used when TrashGuy moves right
+ * @param sprite_right_len  Number of bytes for sprite_right
+ * @param sprite_left       Sprite to be used when TrashGuy moves left
+ * @param sprite_left_len   Number of bytes for sprite_left
+ * @return TGuyBuilder * or NULL on allocation failure, must be passed to tguy_builder_finish() or tguy_builder_free()
+ */
+LIBTGUY_EXPORT TGuyBuilder *tguy_builder_new(unsigned spacing,
+    const char *sprite_space, size_t sprite_space_len,
+    const char *sprite_can, size_t sprite_can_len,
+    const char *sprite_right, size_t sprite_right_len,
+    const char *sprite_left, size_t sprite_left_len);
+
+/**
+ *  Appends next chunk of utf-8 text and splits it into grapheme clusters as far as possible.
+ *  Chunk boundaries may fall anywhere, including the middle of utf-8 sequence or grapheme cluster
+ * @param b            Valid TGuyBuilder *
+ * @param chunk        Part of utf-8 string, copied by the function, NULL is ignored
+ * @param len          Number of bytes chunk has, if -1, then strlen will be used
+ * @return             0 on success, -1 on allocation failure or invalid utf-8, after which builder can only be freed
+ */
+LIBTGUY_EXPORT int tguy_builder_feed(TGuyBuilder *b, const char *chunk, size_t len);
+
+/**
+ *  Creates TrashGuyState from all text passed to tguy_builder_feed(), same as tguy_from_utf8_ex() would.
+ *  State takes over the text copy kept by the builder. Builder is freed in any case
+ * @param b            Valid TGuyBuilder *
+ * @return             TrashGuyState * or NULL on failure, must be freed with tguy_free() after use
+ */
+LIBTGUY_EXPORT TrashGuyState *tguy_builder_finish(TGuyBuilder *b);
+
+/**
+ *  Deallocates memory used by TGuyBuilder without creating a state, does nothing if pointer is NULL
+ * @param b            Valid TGuyBuilder * or NULL
+ */
+LIBTGUY_EXPORT void tguy_builder_free(TGuyBuilder *b);
+
+/**
+ *  Creates new TrashGuysState from a string already split into elements by the caller,
+ *  e.g. with grapheme boundaries from ICU or a language runtime. Element i spans bytes [offsets[i], offsets[i + 1]),
+ *  the last one spans to the end of string. If pointer to sprite is NULL then function will use default one
+ * @param string            String to split, in case of NULL, acts like empty string and len and n are set as 0
+ * @param len               Number of bytes string has, if -1, then strlen will be used
+ * @param offsets           Start offsets of elements, strictly increasing, offsets[0] must be 0 and offsets[n - 1] < len
+ * @param n                 Number of elements, 0 only if string is empty
+ * @param spacing           Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @param sprite_space      Sprite to be used as empty space
+ * @param sprite_space_len  Number of bytes for sprite_space
+ * @param sprite_can        Sprite to be used as trash can
+ * @param sprite_can_len    Number of bytes for sprite_can
+ * @param sprite_right      Sprite to be used when TrashGuy moves right
+ * @param sprite_right_len  Number of bytes for sprite_right
+ * @param sprite_left       Sprite to be used when TrashGuy moves left
+ * @param sprite_left_len   Number of bytes for sprite_left
+ * @param preserve_strings  If set to false function won't make a copy of string
+ *  and will instead rely on caller to preserve it until tguy_free is called, sprites are always copied
+ * @return TrashGuyState * or NULL on allocation failure or invalid offsets, must be freed with tguy_free() after use
+ */
+LIBTGUY_EXPORT TrashGuyState *tguy_from_utf8_offsets(const char *string, size_t len,
+    const uint32_t *offsets, size_t n, unsigned spacing,
+    const char *sprite_space, size_t sprite_space_len,
+    const char *sprite_can, size_t sprite_can_len,
+    const char *sprite_right, size_t sprite_right_len,
+    const char *sprite_left, size_t sprite_left_len,
+    int preserve_strings);
+
+/**
+ *  Creates new lazy TrashGuysState from a utf-8 string. Unlike tguy_from_utf8_ex(), grapheme clusters are only
+ *  split as far ahead as frames being set need, so creation time doesn't depend on the string length. \n
+ *  Until whole string is segmented, its rest is a single last element of tguy_get_arr(),
+ *  tguy_get_frames_count() returns -1 (UINT_MAX) and tguy_get_bsize() returns a larger estimate.
+ *  Setting a frame past the end fails then, call tguy_segment_all() to know the frame count in advance.
+ *  Invalid utf-8 isn't an error, text starting from it is kept as one element
+ * @param string            Utf-8 string, copied by the function, in case of NULL, acts like empty string and len is set as 0
+ * @param len               Number of bytes string has, if -1, then strlen will be used
+ * @param spacing           Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @param sprite_space      Sprite to be used as empty space
+ * @param sprite_space_len  Number of bytes for sprite_space
+ * @param sprite_can        Sprite to be used as trash can
+ * @param sprite_can_len    Number of bytes for sprite_can
+ * @param sprite_right      Sprite to be used when TrashGuy moves right
+ * @param sprite_right_len  Number of bytes for sprite_right
+ * @param sprite_left       Sprite to be used when TrashGuy moves left
+ * @param sprite_left_len   Number of bytes for sprite_left
+ * @return TrashGuyState * or NULL on allocation failure, must be freed with tguy_free() after use
+ */
+LIBTGUY_EXPORT TrashGuyState *tguy_from_utf8_lazy_ex(const char *string, size_t len, unsigned spacing,
+    const char *sprite_space, size_t sprite_space_len,
+    const char *sprite_can, size_t sprite_can_len,
+    const char *sprite_right, size_t sprite_right_len,
+    const char *sprite_left, size_t sprite_left_len);
+
+/**
+ *  Same as tguy_from_utf8_lazy_ex(), optionally without copying the string
+ * @param string            Utf-8 string, in case of NULL, acts like empty string and len is set as 0
+ * @param len               Number of bytes string has, if -1, then strlen will be used
+ * @param spacing           Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @param sprite_space      Sprite to be used as empty space
+ * @param sprite_space_len  Number of bytes for sprite_space
+ * @param sprite_can        Sprite to be used as trash can
+ * @param sprite_can_len    Number of bytes for sprite_can
+ * @param sprite_right      Sprite to be used when TrashGuy moves right
+ * @param sprite_right_len  Number of bytes for sprite_right
+ * @param sprite_left       Sprite to be used when TrashGuy moves left
+ * @param sprite_left_len   Number of bytes for sprite_left
+ * @param preserve_strings  If set to false function won't copy the string and will segment it in place,
+ *  caller must preserve it until tguy_free is called
+ * @return TrashGuyState * or NULL on allocation failure, must be freed with tguy_free() after use
+ */
+LIBTGUY_EXPORT TrashGuyState *tguy_from_utf8_lazy_ex_2(const char *string, size_t len, unsigned spacing,
+    const char *sprite_space, size_t sprite_space_len,
+    const char *sprite_can, size_t sprite_can_len,
+    const char *sprite_right, size_t sprite_right_len,
+    const char *sprite_left, size_t sprite_left_len,
+    int preserve_strings);
+
+/**
+ *  Creates new lazy TrashGuysState from a utf-8 string using default sprites, see tguy_from_utf8_lazy_ex()
+ * @param string       Utf-8 string, copied by the function, in case of NULL, acts like empty string and len is set as 0
+ * @param len          Number of bytes string has, if -1, then strlen will be used
+ * @param spacing      Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @return             TrashGuyState * or NULL on allocation failure, must be freed with tguy_free() after use
+ */
+LIBTGUY_EXPORT TrashGuyState *tguy_from_utf8_lazy(const char string[], size_t len, unsigned spacing);
+
+/**
+ * @param arr               Array of nul-terminated C strings, in case of NULL, acts like empty array and len is set as 0,
+ *  NULL strings act like empty ones
+ * @param len               Number of elements in array
+ * @param spacing           Number of space sprites to be placed between the TrashGuy sprite and fist element initially
+ * @param sprite_space      Sprite to be used as empty space
+ * @param sprite_space_len  Number of bytes for sprite_space
+ * @param sprite_can        Sprite to be used as trash can
+ * @param sprite_can_len    Number of bytes for sprite_can
+ * @param sprite_right      Sprite to be used when TrashGuy moves right
+ * @param sprite_right_len  Number of bytes for sprite_right
+ * @param sprite_left       Sprite to be used when TrashGuy moves left
+ * @param sprite_left_len   Number of bytes for sprite_left
+ * @param preserve_strings  If set to false function won't copy the strings, only the array of pointers is read,
+ *  caller must preserve the strings until tguy_free is called
+ * @return TrashGuyState * or NULL on allocation failure, must be freed with tguy_free() after use
+ */
+LIBTGUY_EXPORT TrashGuyState *tguy_from_cstr_arr_ex_2(const char *const arr[], size_t len, unsigned spacing,
+    const char *sprite_space, size_t sprite_space_len,
+    const char *sprite_can, size_t sprite_can_len,
+    const char *sprite_right, size_t sprite_right_len,
+    const char *sprite_left, size_t sprite_left_len,
+    int preserve_strings);
+
 /**
  * @param arr               Array of nul-terminated C strings, in case of NULL, acts like empty array and len is set as 0
  * @param len               Number of elements in array
@@ -173,7 +359,7 @@ LIBTGUY_EXPORT void tguy_free(TrashGuyState *st);
  *  Sets the current frame for TrashGuyState
  * @param st           Valid TrashGuyState *
  * @param frame        0 <= frame < tguy_get_frames_count()
- * @return             frame on success, -1 (UINT_MAX) on failure
+ * @return             frame on success, -1 (UINT_MAX) on failure, including allocation failure of lazy states
  */
 LIBTGUY_EXPORT unsigned tguy_set_frame(TrashGuyState *st, unsigned frame);
 
@@ -223,13 +409,42 @@ LIBTGUY_EXPORT unsigned tguy_set_pos(TrashGuyState *st, unsigned sprite_pos, uns
 LIBTGUY_EXPORT void tguy_get_frame_state(const TrashGuyState *st, unsigned *frame, unsigned *sprite_pos,
     unsigned *facing_right, unsigned *element_index);
 
+/** @typedef TGuyClearMode
+ *  How the arena is refilled with spaces when tguy_set_frame() jumps to a frame that isn't the next one
+ */
+typedef enum {
+    TGUY_CLEAR_AUTO, /**< default, loop for small arenas and fill for large ones */
+    TGUY_CLEAR_LOOP, /**< assign space sprite to every cell */
+    TGUY_CLEAR_SHADOW, /**< copy from a pre-filled arena, doubles arena memory usage, not available to lazy states */
+    TGUY_CLEAR_FILL /**< copy the first space over the rest in doubling blocks, no extra memory */
+} TGuyClearMode;
+
 /**
- *  Returns number of frames particular TrashGuyState has
+ *  Sets how TrashGuyState clears its arena, only affects speed of non-sequential tguy_set_frame(). \n
+ *  Libraries built with TGUY_USE_FASTCLEAR default to TGUY_CLEAR_SHADOW for states that aren't lazy
  * @param st           Valid TrashGuyState
- * @return             Number of frames, >= 1
+ * @param mode         One of TGuyClearMode values
+ * @return             0 on success, -1 if mode is invalid, unavailable or on allocation failure, mode isn't changed then
+ */
+LIBTGUY_EXPORT int tguy_set_clear_mode(TrashGuyState *st, TGuyClearMode mode);
+
+/**
+ *  Returns number of frames particular TrashGuyState has. \n
+ *  Number of frames of lazy state is unknown until it's segmented completely, either by tguy_segment_all()
+ *  or by setting frames up to its last element
+ * @param st           Valid TrashGuyState
+ * @return             Number of frames, >= 1, or -1 (UINT_MAX) if unknown yet
  */
 LIBTGUY_EXPORT unsigned tguy_get_frames_count(const TrashGuyState *st);
 
+/**
+ *  Segments the rest of lazy state's text, so that tguy_get_frames_count() is known, does nothing for other states.
+ *  Reallocates arena of lazy state, which invalidates arrays returned by tguy_get_arr()
+ * @param st           Valid TrashGuyState
+ * @return             0 on success, -1 on allocation failure, state isn't changed then
+ */
+LIBTGUY_EXPORT int tguy_segment_all(TrashGuyState *st);
+
 /**
  *  Writes currently set TrashGuy frame to fp without newline
  * @param st           Valid TrashGuyState with frame set
@@ -253,6 +468,34 @@ LIBTGUY_EXPORT size_t tguy_print(const TrashGuyState *st);
  */
 LIBTGUY_EXPORT size_t tguy_sprint(const TrashGuyState *st, char buf[]);
 
+/** @def TGUY_WINDOW_FOLLOW
+ *  Special first_cell value for tguy_sprint_window() to keep the window centered on the TrashGuy sprite
+ */
+#define TGUY_WINDOW_FOLLOW ((size_t)-1)
+
+/**
+ *  Writes cells [first_cell, first_cell + n_cells) of the currently set TrashGuy frame to buffer and appends
+ *  nul terminator, cell is a single element of array returned by tguy_get_arr(). \n
+ *  Cost depends on the window size, not on the text length.
+ *  If window goes past the last cell, it's moved to the left so that it ends on the last cell
+ * @param st           Valid TrashGuyState with frame set
+ * @param first_cell   Index of the first cell to draw or TGUY_WINDOW_FOLLOW
+ * @param n_cells      Number of cells to draw
+ * @param buf          Buffer at least tguy_get_window_bsize(n_cells) bytes large
+ * @return             Number of bytes written, excluding the nul terminator, 0 on allocation failure of lazy state.
+ *  Lazy state is segmented as far as the window reaches
+ */
+LIBTGUY_EXPORT size_t tguy_sprint_window(TrashGuyState *st, size_t first_cell, size_t n_cells, char buf[]);
+
+/**
+ *  Get buffer size large enough to hold n_cells cells of any frame including nul terminator, never more than
+ *  tguy_get_bsize(). Doesn't segment lazy state, its unsegmented rest bounds the size of elements to come
+ * @param st           Valid TrashGuyState
+ * @param n_cells      Number of cells in window
+ * @return             Needed buffer size in bytes, including nul terminator
+ */
+LIBTGUY_EXPORT size_t tguy_get_window_bsize(TrashGuyState *st, size_t n_cells);
+
 /**
  *  Get buffer size large enough to hold one frame including nul terminator
  * @param st           Valid TrashGuyState
@@ -261,7 +504,10 @@ LIBTGUY_EXPORT size_t tguy_sprint(const TrashGuyState *st, char buf[]);
 LIBTGUY_EXPORT size_t tguy_get_bsize(TrashGuyState *st);
 
 /**
- *  Returns read-only array view of current TrashGuy frame: TGStrView[]{ {"t",1}, {"e",1}, {"ї",2}, {"s",1}, {"t",1}, {NULL,0} }
+ *  Returns read-only array view of current TrashGuy frame: TGStrView[]{ {"t",1}, {"e",1}, {"ї",2}, {"s",1}, {"t",1}, {NULL,0} }. \n
+ *  Arena of lazy state grows as it gets segmented, so the array is only valid until the next call
+ *  that may segment it: tguy_set_frame(), tguy_set_pos(), tguy_segment_all(), tguy_sprint_window()
+ *  and utf-16/utf-32 functions
  * @param st           Valid TrashGuyState with frame set
  * @param[out,optional] len     Length of the returned array, excluding NULL terminator
  * @return             Array of const TGStrView,  terminated with TGStrView.str == NULL
@@ -276,7 +522,43 @@ LIBTGUY_EXPORT const TGStrView *tguy_get_arr(const TrashGuyState *st, size_t *le
  * @param[out,optional] len    Length of the returned string in bytes
  * @return
  */
-LIBTGUY_EXPORT const char *tguy_get_string(TrashGuyState * restrict st, size_t *len);
+LIBTGUY_EXPORT const char *tguy_get_string(TrashGuyState *st, size_t *len);
+
+/**
+ *  Writes currently set TrashGuy frame to buffer as utf-16 in native byte order and appends nul terminator. \n
+ *  Elements and sprites are transcoded once by tguy_get_bsize_utf16(), which must be called first,
+ *  frames are plain copies then
+ * @param st           Valid TrashGuyState with frame set
+ * @param buf          Buffer at least tguy_get_bsize_utf16() code units large
+ * @return             Number of code units written, excluding the nul terminator,
+ *  0 if tguy_get_bsize_utf16() wasn't called or failed
+ */
+LIBTGUY_EXPORT size_t tguy_sprint_utf16(const TrashGuyState *st, uint16_t buf[]);
+
+/**
+ *  Same as tguy_sprint_utf16(), but writes utf-32, tguy_get_bsize_utf32() must be called first
+ * @param st           Valid TrashGuyState with frame set
+ * @param buf          Buffer at least tguy_get_bsize_utf32() code units large
+ * @return             Number of code units written, excluding the nul terminator,
+ *  0 if tguy_get_bsize_utf32() wasn't called or failed
+ */
+LIBTGUY_EXPORT size_t tguy_sprint_utf32(const TrashGuyState *st, uint32_t buf[]);
+
+/**
+ *  Get buffer size large enough to hold one frame as utf-16 including nul terminator.
+ *  Transcodes elements and sprites on first call, invalid utf-8 is replaced with U+FFFD,
+ *  lazy state gets segmented completely
+ * @param st           Valid TrashGuyState
+ * @return             Needed buffer size in code units, including nul terminator, 0 on allocation failure
+ */
+LIBTGUY_EXPORT size_t tguy_get_bsize_utf16(TrashGuyState *st);
+
+/**
+ *  Get buffer size large enough to hold one frame as utf-32 including nul terminator
+ * @param st           Valid TrashGuyState
+ * @return             Needed buffer size in code units, including nul terminator, 0 on allocation failure
+ */
+LIBTGUY_EXPORT size_t tguy_get_bsize_utf32(TrashGuyState *st);
 
 /**
  *  Returns first frame for when certain element is being processed.
@@ -289,6 +571,208 @@ LIBTGUY_EXPORT const char *tguy_get_string(TrashGuyState * restrict st, size_t *
  */
 LIBTGUY_EXPORT unsigned tguy_get_first_frame_for_element(const TrashGuyState *st, unsigned element_index);
 
+/** @typedef TGuyPlayer
+ *  Anonymous struct typedef for a scheduler that drives frames of many TrashGuyStates from one event loop. \n
+ *  Player is not thread-safe, to spread sessions across N threads create one player per thread.
+ */
+typedef struct TGuyPlayer TGuyPlayer;
+
+/**
+ *  Callback used by TGuyPlayer to hand a rendered frame over to the consumer of the session.
+ *  Should never block, e.g. write()/writev() to a descriptor with O_NONBLOCK set. \n
+ *  Once the animation is over or the session is closed, it's called one last time with buf == NULL and len == 0,
+ *  after that the session is removed and its TrashGuyState can be freed.
+ * @param userdata     Pointer passed to tguy_player_add()
+ * @param buf          Frame bytes, not nul-terminated
+ * @param len          Number of bytes in buf
+ * @return             Number of bytes consumed, 0 <= n <= len, or -1 (SIZE_MAX) to close the session
+ */
+typedef size_t (*TGuyWriteFn)(void *userdata, const char *buf, size_t len);
+
+/** @struct TGuyPlayerStats
+ *  Per-session metrics of TGuyPlayer
+ */
+typedef struct {
+    unsigned frame;          /**< Last frame rendered, -1 (UINT_MAX) if none were rendered yet           */
+    unsigned frames_written; /**< Number of frames fully consumed by TGuyWriteFn                        */
+    unsigned frames_dropped; /**< Number of frames skipped because consumer or player couldn't keep up */
+    size_t backlog;          /**< Bytes of the last rendered frame consumer has yet to accept           */
+    uint64_t last_latency;   /**< How late the last frame was rendered relative to its deadline         */
+    uint64_t max_latency;    /**< Largest last_latency observed                                          */
+} TGuyPlayerStats;
+
+/**
+ *  Creates new TGuyPlayer with a timing wheel of given granularity. Time units are up to the caller,
+ *  but must be the same for every function taking time, e.g. milliseconds from CLOCK_MONOTONIC
+ * @param tick         Timing wheel granularity, deadlines are rounded down to it, 0 is treated as 1
+ * @param now          Current time
+ * @return             TGuyPlayer * or NULL on allocation failure, must be freed with tguy_player_free() after use
+ */
+LIBTGUY_EXPORT TGuyPlayer *tguy_player_new(unsigned tick, uint64_t now);
+
+/**
+ *  Deallocates memory used by a TGuyPlayer, does nothing if pointer is NULL.
+ *  Remaining sessions are dropped without calling their TGuyWriteFn, states passed to tguy_player_add() aren't freed
+ * @param p            Valid TGuyPlayer * or NULL
+ */
+LIBTGUY_EXPORT void tguy_player_free(TGuyPlayer *p);
+
+/**
+ *  Adds new session playing st from its first frame, first frame is due on the next tguy_player_advance() call.
+ *  Player doesn't take ownership of st, but exclusively uses it until the session is over
+ * @param p            Valid TGuyPlayer *
+ * @param st           Valid TrashGuyState *
+ * @param interval     Time between two consecutive frames, 0 is treated as 1
+ * @param write        Callback to deliver frames to
+ * @param userdata     Pointer passed as is to write
+ * @return             Session id or -1 (SIZE_MAX) on allocation failure, ids of finished sessions are reused
+ */
+LIBTGUY_EXPORT size_t tguy_player_add(TGuyPlayer *p, TrashGuyState *st, unsigned interval,
+    TGuyWriteFn write, void *userdata);
+
+/**
+ *  Removes the session without calling its TGuyWriteFn
+ * @param p            Valid TGuyPlayer *
+ * @param id           Session id returned by tguy_player_add()
+ * @return             0 on success, -1 if there's no such session
+ */
+LIBTGUY_EXPORT int tguy_player_remove(TGuyPlayer *p, size_t id);
+
+/**
+ *  Renders and delivers all frames which are due at now.
+ *  If consumer didn't accept the whole previous frame, its remainder is written first and the new frame
+ *  is dropped unless the remainder went through, so slow consumers get fewer but complete frames.
+ *  Sessions that fell behind by several intervals skip straight to the latest due frame.
+ * @param p            Valid TGuyPlayer *
+ * @param now          Current time, must not go backwards
+ * @return             Number of frames rendered
+ */
+LIBTGUY_EXPORT size_t tguy_player_advance(TGuyPlayer *p, uint64_t now);
+
+/**
+ *  Returns the earliest deadline among active sessions, use it to arm timerfd or as epoll_wait() timeout
+ * @param p            Valid TGuyPlayer *
+ * @return             Deadline or UINT64_MAX if there are no sessions
+ */
+LIBTGUY_EXPORT uint64_t tguy_player_next_deadline(const TGuyPlayer *p);
+
+/**
+ * @param p            Valid TGuyPlayer *
+ * @param id           Session id returned by tguy_player_add()
+ * @param[out] stats   Where to store the metrics of the session
+ * @return             0 on success, -1 if there's no such session
+ */
+LIBTGUY_EXPORT int tguy_player_get_stats(const TGuyPlayer *p, size_t id, TGuyPlayerStats *stats);
+
+/** @typedef TGuyCompositor
+ *  Anonymous struct typedef for a set of TrashGuyStates rendered into rows of one screen buffer
+ */
+typedef struct TGuyCompositor TGuyCompositor;
+
+/**
+ *  Creates new empty TGuyCompositor
+ * @return             TGuyCompositor * or NULL on allocation failure, must be freed with tguy_compositor_free() after use
+ */
+LIBTGUY_EXPORT TGuyCompositor *tguy_compositor_new(void);
+
+/**
+ *  Deallocates memory used by a TGuyCompositor, does nothing if pointer is NULL.
+ *  States passed to tguy_compositor_add() aren't freed
+ * @param c            Valid TGuyCompositor * or NULL
+ */
+LIBTGUY_EXPORT void tguy_compositor_free(TGuyCompositor *c);
+
+/**
+ *  Registers st to be drawn at the row, compositor doesn't take ownership of st.
+ *  Its currently set frame is drawn on the next tguy_compositor_render()
+ * @param c            Valid TGuyCompositor *
+ * @param st           Valid TrashGuyState *
+ * @param row          Screen row, starting from 0
+ * @return             Entry id or -1 (SIZE_MAX) on allocation failure, ids of removed entries are reused
+ */
+LIBTGUY_EXPORT size_t tguy_compositor_add(TGuyCompositor *c, TrashGuyState *st, unsigned row);
+
+/**
+ *  Unregisters entry, its row is left as is on the screen
+ * @param c            Valid TGuyCompositor *
+ * @param id           Entry id returned by tguy_compositor_add()
+ * @return             0 on success, -1 if there's no such entry
+ */
+LIBTGUY_EXPORT int tguy_compositor_remove(TGuyCompositor *c, size_t id);
+
+/**
+ *  Advances every registered state which isn't on its last frame by one frame
+ * @param c            Valid TGuyCompositor *
+ * @return             Number of states which haven't reached their last frame yet
+ */
+LIBTGUY_EXPORT size_t tguy_compositor_tick(TGuyCompositor *c);
+
+/**
+ *  Renders rows whose frame changed since the previous call into one buffer,
+ *  each row is prefixed with ANSI cursor position sequence and followed by erase to end of line sequence.
+ *  Does NOT need to be freed manually, is valid until next call or tguy_compositor_free()
+ * @param c            Valid TGuyCompositor *
+ * @param[out,optional] len    Length of the returned string in bytes, 0 if nothing changed
+ * @return             nul-terminated screen update or NULL on allocation failure
+ */
+LIBTGUY_EXPORT const char *tguy_compositor_render(TGuyCompositor *c, size_t *len);
+
+/** @typedef TGuyRing
+ *  Lock-free single-producer single-consumer ring of frames rendered ahead of time. \n
+ *  Producer thread calls tguy_ring_produce() to render frames of the state sequentially into free slots,
+ *  consumer thread takes them with tguy_ring_acquire() and tguy_ring_release() and may restart from any frame
+ *  with tguy_ring_seek(). Library doesn't start any threads, both loops are up to the caller
+ */
+typedef struct TGuyRing TGuyRing;
+
+/**
+ *  Creates new TGuyRing with n_slots slots, tguy_get_bsize() bytes each. Ring doesn't take ownership of st,
+ *  but until tguy_ring_free() st must only be used by the producer through the ring. Producer starts from frame 0
+ * @param st           Valid TrashGuyState *
+ * @param n_slots      Number of frames that can be rendered ahead, > 0
+ * @return             TGuyRing * or NULL on allocation failure or if the library was built without atomics support,
+ *  must be freed with tguy_ring_free() after use
+ */
+LIBTGUY_EXPORT TGuyRing *tguy_ring_new(TrashGuyState *st, size_t n_slots);
+
+/**
+ *  Deallocates memory used by a TGuyRing, does nothing if pointer is NULL. State isn't freed.
+ *  Neither producer nor consumer may use the ring anymore
+ * @param r            Valid TGuyRing * or NULL
+ */
+LIBTGUY_EXPORT void tguy_ring_free(TGuyRing *r);
+
+/**
+ *  Producer side: renders the next frame into a free slot and publishes it, never blocks
+ * @param r            Valid TGuyRing *
+ * @return             1 if frame was published, 0 if ring is full, -1 if there are no frames left until next seek
+ */
+LIBTGUY_EXPORT int tguy_ring_produce(TGuyRing *r);
+
+/**
+ *  Consumer side: returns the oldest ready frame without removing it from the ring, never blocks or allocates.
+ *  Frame stays valid until tguy_ring_release() or tguy_ring_seek()
+ * @param r            Valid TGuyRing *
+ * @param[out,optional] frame  Frame index
+ * @param[out,optional] len    Length of the frame in bytes
+ * @return             nul-terminated frame or NULL if no frame is ready
+ */
+LIBTGUY_EXPORT const char *tguy_ring_acquire(TGuyRing *r, unsigned *frame, size_t *len);
+
+/**
+ *  Consumer side: hands the slot of frame returned by tguy_ring_acquire() back to the producer
+ * @param r            Valid TGuyRing * with frame acquired
+ */
+LIBTGUY_EXPORT void tguy_ring_release(TGuyRing *r);
+
+/**
+ *  Consumer side: drops every ready frame, including the acquired one, and makes producer continue from frame.
+ *  Frames rendered before producer notices the seek are skipped by tguy_ring_acquire()
+ * @param r            Valid TGuyRing *
+ * @param frame        Frame to continue from, if it's out of range tguy_ring_produce() returns -1 until next seek
+ */
+LIBTGUY_EXPORT void tguy_ring_seek(TGuyRing *r, unsigned frame);
+
 /**
  *  Get version as integer in format MMMmmmppp. 020107002 -> 20.107.2
  * @return Version number
@@ -0,0 +1,264 @@
+#ifndef LIBTGUY_HPP
+#define LIBTGUY_HPP
+
+/**
+ * @file libtguy.hpp
+ *  C++17 header-only wrapper over libtguy.h: RAII owner of TrashGuyState, frame views and frame ranges
+ */
+
+#if !(__cplusplus >= 201703L || (defined _MSVC_LANG && _MSVC_LANG >= 201703L))
+    #error "libtguy.hpp requires C++17"
+#endif
+
+#include <libtguy.h>
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#if __cplusplus >= 202002L || (defined _MSVC_LANG && _MSVC_LANG >= 202002L)
+    #include <span>
+#endif
+
+namespace tguy {
+
+/** @defgroup FRAME_MATH Compile-time frame math
+ *  Mirrors the computations done by TrashGuyState, usable in constant expressions
+ *@{*/
+
+/**
+ *  Number of frames spent to process the first element
+ * @param spacing Spacing passed to the constructor
+ */
+constexpr unsigned first_element_frames_count(unsigned spacing) noexcept { return (spacing + 1) * 2; }
+
+/**
+ *  Same as tguy_get_first_frame_for_element()
+ * @param spacing       Spacing passed to the constructor
+ * @param element_index Element index
+ */
+constexpr unsigned first_frame_for_element(unsigned spacing, unsigned element_index) noexcept {
+    return element_index * (element_index + first_element_frames_count(spacing) - 1);
+}
+
+/**
+ *  Same as tguy_get_frames_count() of a state with n_elements elements
+ * @param spacing    Spacing passed to the constructor
+ * @param n_elements Number of elements
+ */
+constexpr unsigned frames_count(unsigned spacing, std::size_t n_elements) noexcept {
+    return first_frame_for_element(spacing, static_cast<unsigned>(n_elements)) + 1;
+}
+
+/**
+ *  Number of codepoints in utf-8 string, equals number of elements tguy_from_utf8() makes
+ *  as long as every grapheme cluster of text is a single codepoint
+ * @param text utf-8 string
+ */
+constexpr std::size_t codepoints_count(std::string_view text) noexcept {
+    std::size_t n = 0;
+    for (char c : text) n += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    return n;
+}
+
+/**@}*/
+
+#if __cplusplus >= 202002L || (defined _MSVC_LANG && _MSVC_LANG >= 202002L)
+/** Read-only view of the arena */
+using ArenaView = std::span<const TGStrView>;
+#else
+/** Read-only view of the arena, std::span<const TGStrView> in C++20 */
+class ArenaView {
+public:
+    constexpr ArenaView(const TGStrView *data, std::size_t size) noexcept : data_(data), size_(size) {}
+    constexpr const TGStrView *data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr const TGStrView &operator[](std::size_t i) const noexcept { return data_[i]; }
+    constexpr const TGStrView *begin() const noexcept { return data_; }
+    constexpr const TGStrView *end() const noexcept { return data_ + size_; }
+private:
+    const TGStrView *data_;
+    std::size_t size_;
+};
+#endif
+
+/**
+ *  Input iterator over frames of a state, dereferencing sets the frame and returns a view of it.
+ *  View stays valid until another frame is set. Iterating forward uses the sequential fast path of tguy_set_frame().
+ *  All iterators of a state share it, so only the last dereferenced frame is valid at a time,
+ *  operator[] returns a copy instead to be safe to keep. Iterator can be moved by any distance,
+ *  but isn't a random access one for algorithms, which may hold views of several frames
+ */
+class FrameIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::string_view;
+    using pointer = void;
+
+    FrameIterator() noexcept = default;
+    FrameIterator(TrashGuyState *st, unsigned frame) noexcept : st_(st), frame_(frame) {}
+
+    /**
+     * @throw std::out_of_range if frame is past the last one
+     * @throw std::bad_alloc if output string couldn't be allocated
+     */
+    std::string_view operator*() const {
+        std::size_t len;
+        if (frame_ >= tguy_get_frames_count(st_) || tguy_set_frame(st_, frame_) == -1u) {
+            throw std::out_of_range("tguy: frame out of range");
+        }
+        const char *str = tguy_get_string(st_, &len);
+        if (str == nullptr) throw std::bad_alloc();
+        return {str, len};
+    }
+    /** Copy of the frame n frames away, see operator*() */
+    std::string operator[](difference_type n) const { return std::string(*(*this + n)); }
+
+    /** Current frame index */
+    unsigned frame() const noexcept { return frame_; }
+
+    FrameIterator &operator++() noexcept { ++frame_; return *this; }
+    FrameIterator operator++(int) noexcept { FrameIterator it = *this; ++frame_; return it; }
+    FrameIterator &operator--() noexcept { --frame_; return *this; }
+    FrameIterator operator--(int) noexcept { FrameIterator it = *this; --frame_; return it; }
+    FrameIterator &operator+=(difference_type n) noexcept {
+        frame_ = static_cast<unsigned>(static_cast<difference_type>(frame_) + n);
+        return *this;
+    }
+    FrameIterator &operator-=(difference_type n) noexcept { return *this += -n; }
+    friend FrameIterator operator+(FrameIterator it, difference_type n) noexcept { return it += n; }
+    friend FrameIterator operator+(difference_type n, FrameIterator it) noexcept { return it += n; }
+    friend FrameIterator operator-(FrameIterator it, difference_type n) noexcept { return it -= n; }
+    friend difference_type operator-(const FrameIterator &a, const FrameIterator &b) noexcept {
+        return static_cast<difference_type>(a.frame_) - static_cast<difference_type>(b.frame_);
+    }
+    friend bool operator==(const FrameIterator &a, const FrameIterator &b) noexcept { return a.frame_ == b.frame_; }
+    friend bool operator!=(const FrameIterator &a, const FrameIterator &b) noexcept { return a.frame_ != b.frame_; }
+    friend bool operator<(const FrameIterator &a, const FrameIterator &b) noexcept { return a.frame_ < b.frame_; }
+    friend bool operator>(const FrameIterator &a, const FrameIterator &b) noexcept { return a.frame_ > b.frame_; }
+    friend bool operator<=(const FrameIterator &a, const FrameIterator &b) noexcept { return a.frame_ <= b.frame_; }
+    friend bool operator>=(const FrameIterator &a, const FrameIterator &b) noexcept { return a.frame_ >= b.frame_; }
+
+private:
+    TrashGuyState *st_ = nullptr;
+    unsigned frame_ = 0;
+};
+
+/**
+ *  Range of frames [first, last) of a state, empty if first > last
+ */
+class FrameRange {
+public:
+    FrameRange(TrashGuyState *st, unsigned first, unsigned last) noexcept
+        : first_(st, first), last_(st, last < first ? first : last) {}
+    FrameIterator begin() const noexcept { return first_; }
+    FrameIterator end() const noexcept { return last_; }
+    std::size_t size() const noexcept { return static_cast<std::size_t>(last_ - first_); }
+    /** Copy of the i-th frame of the range, see FrameIterator::operator[]() */
+    std::string operator[](std::size_t i) const { return first_[static_cast<std::ptrdiff_t>(i)]; }
+private:
+    FrameIterator first_, last_;
+};
+
+/**
+ *  Move-only owner of TrashGuyState
+ */
+class State {
+public:
+    /** Takes ownership of st, which may be NULL */
+    explicit State(TrashGuyState *st) noexcept : st_(st) {}
+
+    /**
+     *  Same as tguy_from_utf8()
+     * @throw std::runtime_error on allocation failure or invalid utf-8
+     */
+    static State from_utf8(std::string_view text, unsigned spacing) {
+        return checked(tguy_from_utf8(text.data(), text.size(), spacing));
+    }
+
+    /**
+     *  Same as tguy_from_arr()
+     * @throw std::runtime_error on allocation failure
+     */
+    static State from_arr(const TGStrView *arr, std::size_t len, unsigned spacing) {
+        return checked(tguy_from_arr(arr, len, spacing));
+    }
+
+    State(const State &) = delete;
+    State &operator=(const State &) = delete;
+    State(State &&other) noexcept : st_(std::exchange(other.st_, nullptr)) {}
+    State &operator=(State &&other) noexcept {
+        if (this != &other) {
+            tguy_free(st_);
+            st_ = std::exchange(other.st_, nullptr);
+        }
+        return *this;
+    }
+    ~State() { tguy_free(st_); }
+
+    /** Underlying state, still owned by this object */
+    TrashGuyState *get() const noexcept { return st_; }
+    /** Gives up ownership of the underlying state */
+    TrashGuyState *release() noexcept { return std::exchange(st_, nullptr); }
+    explicit operator bool() const noexcept { return st_ != nullptr; }
+
+    /** Same as tguy_get_frames_count(), doesn't segment lazy state, so it's -1 (UINT_MAX) until segmented */
+    unsigned frames_count() const noexcept { return tguy_get_frames_count(st_); }
+    /** Same as tguy_set_frame() */
+    unsigned set_frame(unsigned frame) noexcept { return tguy_set_frame(st_, frame); }
+
+    /**
+     *  View of the currently set frame, valid until another frame is set
+     * @throw std::bad_alloc if output string couldn't be allocated
+     */
+    std::string_view string() const {
+        std::size_t len;
+        const char *str = tguy_get_string(st_, &len);
+        if (str == nullptr) throw std::bad_alloc();
+        return {str, len};
+    }
+
+    /**
+     *  Sets the frame and returns its view, see string()
+     * @throw std::out_of_range if frame is past the last one
+     */
+    std::string_view frame(unsigned frame) {
+        return *FrameIterator(st_, frame);
+    }
+
+    /** Cells of the currently set frame, same as tguy_get_arr() */
+    ArenaView arena() const noexcept {
+        std::size_t len;
+        const TGStrView *arr = tguy_get_arr(st_, &len);
+        return {arr, len};
+    }
+
+    /**
+     *  All frames of the state, lazy state is segmented completely first to know where they end
+     * @throw std::bad_alloc on allocation failure of lazy state
+     */
+    FrameRange frames() {
+        if (tguy_segment_all(st_) != 0) throw std::bad_alloc();
+        return {st_, 0, frames_count()};
+    }
+    /** Frames [first, last) of the state, empty if first > last */
+    FrameRange frames(unsigned first, unsigned last) const noexcept { return {st_, first, last}; }
+
+private:
+    static State checked(TrashGuyState *st) {
+        if (st == nullptr) throw std::runtime_error("tguy: failed to create TrashGuyState");
+        return State(st);
+    }
+
+    TrashGuyState *st_;
+};
+
+} // namespace tguy
+
+#endif /* LIBTGUY_HPP */
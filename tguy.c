@@ -0,0 +1,552 @@
+#if !defined _WIN32 && !defined _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <libtguy.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef TGUY_CLI_PTHREADS
+#include <pthread.h>
+#endif
+
+/**
+ * @file tguy.c
+ *  Command-line renderer: reads messages line by line and writes every frame of each one on its own line
+ */
+
+/** Size of input reads */
+#define IN_CHUNK (1u << 20)
+/** Output is flushed to stdout before buffer grows past this size */
+#define OUT_FLUSH (1u << 22)
+/** Initial size of output buffers */
+#define OUT_MIN (1u << 12)
+/** Parallel workers hand rendered frames to the writer in chunks of about this size */
+#define OUT_CHUNK (1u << 20)
+/** Maximum number of messages read before they're rendered */
+#define BATCH_MESSAGES 1024u
+/** Parallel workers render runs of consecutive messages up to this many bytes long at once... */
+#define GROUP_BYTES 1024u
+/** ...and up to this many messages */
+#define GROUP_MESSAGES 64u
+
+/**
+ * Command-line options
+ */
+typedef struct {
+    unsigned spacing; /**< --spacing */
+    unsigned first; /**< first frame of --frames */
+    unsigned last; /**< last frame of --frames, inclusive, -1 (UINT_MAX) for the last frame of message */
+    unsigned threads; /**< --threads */
+    int stats; /**< --stats */
+} Options;
+
+/**
+ * Growing output buffer, emptied by flush callback before it grows past flush_at
+ */
+typedef struct OutBuf {
+    char *data;
+    size_t len;
+    size_t cap;
+    int (*flush)(struct OutBuf *out); /**< empties the buffer, returns 0 on failure */
+    size_t flush_at;
+    FILE *fp; /**< where out_write() writes */
+    unsigned long long written; /**< number of bytes written to fp */
+    int failed; /**< set on allocation or flush failure */
+} OutBuf;
+
+/**
+ * Message to render and its results
+ */
+typedef struct {
+    const char *str;
+    size_t len;
+    unsigned long long line; /**< line number in its file, starting from 1 */
+    unsigned long long frames; /**< number of frames rendered */
+    int skipped; /**< set if message couldn't be turned into a state */
+    /* parallel mode, set for the first job of a group and guarded by Batch::lock */
+    const char *chunk; /**< rendered frames of the group waiting for the writer, NULL if none */
+    size_t chunk_len;
+    size_t group_end; /**< index of the job after the last one of the group */
+    int done; /**< set once the whole group is handed over */
+    int failed; /**< set if the group couldn't be rendered */
+} Job;
+
+static double now_seconds(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+/* flush callback writing to fp */
+static int out_write(OutBuf *out) {
+    if (fwrite(out->data, 1, out->len, out->fp) != out->len) {
+        if (!out->failed) fprintf(stderr, "tguy: write error: %s\n", strerror(errno));
+        out->failed = 1;
+    }
+    out->written += out->len;
+    out->len = 0;
+    return !out->failed;
+}
+
+static int out_flush(OutBuf *out) {
+    if (out->len) return out->flush(out);
+    return !out->failed;
+}
+
+/* makes sure at least n more bytes fit into the buffer */
+static int out_reserve(OutBuf *out, size_t n) {
+    if (out->len + n <= out->cap) return 1;
+    if (out->len && out->len + n > out->flush_at && !out_flush(out)) return 0;
+    if (out->len + n > out->cap) {
+        size_t cap = out->cap ? out->cap : OUT_MIN;
+        while (cap < out->len + n && cap <= (size_t)-1 / 2) cap *= 2;
+        char *data = (cap >= out->len + n) ? realloc(out->data, cap) : NULL;
+        if (data == NULL) {
+            fprintf(stderr, "tguy: out of memory\n");
+            out->failed = 1;
+            return 0;
+        }
+        out->data = data;
+        out->cap = cap;
+    }
+    return 1;
+}
+
+static void render_job(Job *job, const Options *opts, OutBuf *out) {
+    TrashGuyState *st = tguy_from_utf8(job->str, job->len, opts->spacing);
+    unsigned last;
+    size_t bsize;
+    job->frames = 0;
+    job->skipped = (st == NULL);
+    if (st == NULL) return;
+    bsize = tguy_get_bsize(st);
+    last = tguy_get_frames_count(st) - 1;
+    if (opts->last < last) last = opts->last;
+    for (unsigned frame = opts->first; frame <= last; frame++) {
+        if (!out_reserve(out, bsize)) break;
+        tguy_set_frame(st, frame);
+        out->len += tguy_sprint(st, &out->data[out->len]);
+        /* replace nul terminator with newline */
+        out->data[out->len++] = '\n';
+        job->frames++;
+    }
+    tguy_free(st);
+}
+
+/* reports message that couldn't be rendered, returns 1 if it was skipped */
+static int job_skipped(const Job *job, const char *name) {
+    if (job->skipped) {
+        fprintf(stderr, "tguy: %s:%llu: invalid utf-8 or out of memory, line skipped\n", name, job->line);
+    }
+    return job->skipped;
+}
+
+#ifdef TGUY_CLI_PTHREADS
+/**
+ * Batch rendered in parallel: workers claim groups of consecutive jobs and hand their output over
+ * in chunks to the writer, which takes them in input order
+ */
+typedef struct {
+    Job *jobs;
+    size_t n_jobs;
+    const Options *opts;
+    pthread_mutex_t lock;
+    pthread_cond_t cond; /**< broadcast on every change of the fields below and of jobs' chunks */
+    size_t next_job; /**< first job not claimed yet */
+    int abort; /**< set when the writer stops, workers quit then */
+} Batch;
+
+/**
+ * Worker of parallel mode, owns two chunk buffers: one is filled while the other one waits for the writer
+ */
+typedef struct {
+    OutBuf out; /**< chunk being filled, must be the first member, flush callback gets it */
+    char *spare; /**< the other chunk */
+    size_t spare_cap;
+    Job *spare_owner; /**< first job of the group spare was handed over for, NULL if it's free */
+    Job *head; /**< first job of the group being rendered */
+    Batch *batch;
+} Worker;
+
+/* flush callback of workers, hands the chunk over and continues in the spare one */
+static int worker_flush(OutBuf *out) {
+    Worker *w = (Worker *)out;
+    Batch *b = w->batch;
+    pthread_mutex_lock(&b->lock);
+    /* group has one chunk waiting at a time and spare may still be written */
+    while (!b->abort && (w->head->chunk != NULL || (w->spare_owner != NULL && w->spare_owner->chunk == w->spare))) {
+        pthread_cond_wait(&b->cond, &b->lock);
+    }
+    if (!b->abort) {
+        char *data = out->data;
+        size_t cap = out->cap;
+        w->head->chunk = data;
+        w->head->chunk_len = out->len;
+        w->spare_owner = w->head;
+        out->data = w->spare;
+        out->cap = w->spare_cap;
+        out->len = 0;
+        w->spare = data;
+        w->spare_cap = cap;
+        pthread_cond_broadcast(&b->cond);
+    } else {
+        out->failed = 1;
+    }
+    pthread_mutex_unlock(&b->lock);
+    return !out->failed;
+}
+
+static void *worker_run(void *arg) {
+    Worker *w = arg;
+    Batch *b = w->batch;
+    while (!w->out.failed) {
+        size_t first, end, bytes;
+        pthread_mutex_lock(&b->lock);
+        if (b->abort || b->next_job == b->n_jobs) {
+            pthread_mutex_unlock(&b->lock);
+            break;
+        }
+        /* short messages are claimed together so that the writer isn't woken for each one */
+        first = b->next_job;
+        bytes = b->jobs[first].len;
+        for (end = first + 1; end < b->n_jobs && end - first < GROUP_MESSAGES; end++) {
+            if (bytes + b->jobs[end].len > GROUP_BYTES) break;
+            bytes += b->jobs[end].len;
+        }
+        b->next_job = end;
+        b->jobs[first].group_end = end;
+        pthread_mutex_unlock(&b->lock);
+
+        w->head = &b->jobs[first];
+        for (size_t i = first; i < end && !w->out.failed; i++) render_job(&b->jobs[i], b->opts, &w->out);
+        if (!w->out.failed) out_flush(&w->out);
+
+        pthread_mutex_lock(&b->lock);
+        w->head->failed = w->out.failed;
+        w->head->done = 1;
+        pthread_cond_broadcast(&b->cond);
+        pthread_mutex_unlock(&b->lock);
+    }
+    return NULL;
+}
+
+/* writes groups of the batch in input order as workers hand them over, returns 1 on success */
+static int batch_write(Batch *b, OutBuf *out, const char *name,
+                       unsigned long long *frames, unsigned long long *skipped) {
+    int ok = 1;
+    pthread_mutex_lock(&b->lock);
+    for (size_t i = 0; i < b->n_jobs && ok;) {
+        Job *head = &b->jobs[i];
+        size_t end;
+        while (head->chunk == NULL && !head->done) pthread_cond_wait(&b->cond, &b->lock);
+        if (head->chunk != NULL) {
+            /* chunk belongs to the worker, it's only read here */
+            pthread_mutex_unlock(&b->lock);
+            ok = out_reserve(out, head->chunk_len);
+            if (ok) {
+                memcpy(&out->data[out->len], head->chunk, head->chunk_len);
+                out->len += head->chunk_len;
+            }
+            pthread_mutex_lock(&b->lock);
+            head->chunk = NULL;
+            pthread_cond_broadcast(&b->cond);
+            continue;
+        }
+        end = head->group_end;
+        ok = !head->failed;
+        pthread_mutex_unlock(&b->lock);
+        for (; i < end; i++) {
+            *skipped += job_skipped(&b->jobs[i], name);
+            *frames += b->jobs[i].frames;
+        }
+        pthread_mutex_lock(&b->lock);
+    }
+    /* everything is written or the rest is dropped */
+    b->abort = 1;
+    pthread_cond_broadcast(&b->cond);
+    pthread_mutex_unlock(&b->lock);
+    return ok;
+}
+#endif
+
+/**
+ * Renders batch of jobs and writes results in input order
+ * @param name  File name for diagnostics
+ * @param[in,out] frames  Incremented by number of rendered frames
+ * @param[in,out] skipped Incremented by number of skipped messages
+ * @return 1 on success, 0 on failure
+ */
+static int render_batch(Job *jobs, size_t n_jobs, const Options *opts, OutBuf *out, const char *name,
+                        unsigned long long *frames, unsigned long long *skipped) {
+#ifdef TGUY_CLI_PTHREADS
+    if (opts->threads > 1 && n_jobs > 1) {
+        pthread_t tids[64];
+        Worker workers[64];
+        Batch batch;
+        size_t n_threads = opts->threads < n_jobs ? opts->threads : n_jobs;
+        size_t started = 0;
+        int ok;
+        if (n_threads > 64) n_threads = 64;
+        batch.jobs = jobs;
+        batch.n_jobs = n_jobs;
+        batch.opts = opts;
+        batch.next_job = 0;
+        batch.abort = 0;
+        for (size_t i = 0; i < n_jobs; i++) {
+            jobs[i].chunk = NULL;
+            jobs[i].done = 0;
+        }
+        if (pthread_mutex_init(&batch.lock, NULL) != 0) goto serial;
+        if (pthread_cond_init(&batch.cond, NULL) != 0) {
+            pthread_mutex_destroy(&batch.lock);
+            goto serial;
+        }
+        for (; started < n_threads; started++) {
+            workers[started] = (Worker){{NULL, 0, 0, worker_flush, OUT_CHUNK, NULL, 0, 0}, NULL, 0, NULL, NULL, &batch};
+            if (pthread_create(&tids[started], NULL, worker_run, &workers[started]) != 0) break;
+        }
+        if (started == 0) {
+            pthread_cond_destroy(&batch.cond);
+            pthread_mutex_destroy(&batch.lock);
+            goto serial;
+        }
+        /* this thread writes while workers render */
+        ok = batch_write(&batch, out, name, frames, skipped);
+        for (size_t i = 0; i < started; i++) {
+            pthread_join(tids[i], NULL);
+            free(workers[i].out.data);
+            free(workers[i].spare);
+        }
+        pthread_cond_destroy(&batch.cond);
+        pthread_mutex_destroy(&batch.lock);
+        return ok && out_flush(out);
+    }
+serial:
+#endif
+    for (size_t i = 0; i < n_jobs; i++) {
+        render_job(&jobs[i], opts, out);
+        *skipped += job_skipped(&jobs[i], name);
+        *frames += jobs[i].frames;
+        if (out->failed) return 0;
+    }
+    return out_flush(out);
+}
+
+/**
+ * Reads whole lines from fp in batches and renders them
+ * @param name  File name for diagnostics
+ * @return 1 on success, 0 on failure
+ */
+static int process_file(FILE *fp, const char *name, const Options *opts, OutBuf *out,
+                        unsigned long long *n_messages, unsigned long long *n_frames,
+                        unsigned long long *n_skipped, unsigned long long *n_in) {
+    unsigned long long line = 0;
+    char *buf = NULL;
+    size_t len = 0, cap = 0, start = 0;
+    Job *jobs = calloc(BATCH_MESSAGES, sizeof(jobs[0]));
+    int eof = 0, ok = jobs != NULL;
+
+    while (ok && !eof) {
+        size_t n_jobs = 0, scan;
+        /* keep the unfinished line at the beginning of buffer */
+        if (start) {
+            memmove(buf, &buf[start], len - start);
+            len -= start;
+            start = 0;
+        }
+        /* unfinished line has no newline in it, don't scan it again */
+        scan = len;
+        if (cap - len < IN_CHUNK) {
+            char *nbuf = realloc(buf, cap + IN_CHUNK);
+            if (nbuf == NULL) {
+                fprintf(stderr, "tguy: out of memory\n");
+                ok = 0;
+                break;
+            }
+            buf = nbuf;
+            cap += IN_CHUNK;
+        }
+        size_t n = fread(&buf[len], 1, cap - len, fp);
+        *n_in += n;
+        len += n;
+        if (n == 0) {
+            if (ferror(fp)) {
+                fprintf(stderr, "tguy: %s: read error: %s\n", name, strerror(errno));
+                ok = 0;
+            }
+            eof = 1;
+        }
+
+        while (start < len) {
+            char *nl = memchr(&buf[scan], '\n', len - scan);
+            size_t end;
+            if (nl == NULL) {
+                /* incomplete line, read more unless it's the last one */
+                if (!eof) break;
+                end = len;
+            } else {
+                end = (size_t)(nl - buf);
+            }
+            jobs[n_jobs].str = &buf[start];
+            jobs[n_jobs].len = (end > start && buf[end - 1] == '\r') ? end - start - 1 : end - start;
+            jobs[n_jobs].line = ++line;
+            n_jobs++;
+            start = scan = (end < len) ? end + 1 : len;
+            if (n_jobs == BATCH_MESSAGES) {
+                ok = render_batch(jobs, n_jobs, opts, out, name, n_frames, n_skipped);
+                *n_messages += n_jobs;
+                n_jobs = 0;
+                if (!ok) break;
+            }
+        }
+        if (ok && n_jobs) {
+            ok = render_batch(jobs, n_jobs, opts, out, name, n_frames, n_skipped);
+            *n_messages += n_jobs;
+        }
+    }
+
+    free(jobs);
+    free(buf);
+    return ok;
+}
+
+static int parse_unsigned(const char *s, unsigned *res) {
+    char *end;
+    unsigned long v;
+    if (*s < '0' || *s > '9') return 0;
+    v = strtoul(s, &end, 10);
+    if (*end != '\0' || v >= (unsigned)-1) return 0;
+    *res = (unsigned)v;
+    return 1;
+}
+
+/* parses FIRST:LAST, FIRST:, :LAST or FRAME */
+static int parse_range(const char *s, unsigned *first, unsigned *last) {
+    char tmp[64];
+    char *colon;
+    if (strlen(s) >= sizeof(tmp)) return 0;
+    strcpy(tmp, s);
+    colon = strchr(tmp, ':');
+    if (colon == NULL) {
+        if (!parse_unsigned(tmp, first)) return 0;
+        *last = *first;
+        return 1;
+    }
+    *colon = '\0';
+    *first = 0;
+    *last = (unsigned)-1;
+    if (tmp[0] != '\0' && !parse_unsigned(tmp, first)) return 0;
+    if (colon[1] != '\0' && !parse_unsigned(colon + 1, last)) return 0;
+    return *first <= *last;
+}
+
+static void usage(FILE *fp) {
+    fprintf(fp,
+        "Usage: tguy [OPTION]... [FILE]...\n"
+        "Render TrashGuy animation frames for every line of FILEs or standard input.\n"
+        "With no FILE, or when FILE is -, read standard input.\n"
+        "\n"
+        "  -s, --spacing N       spacing before the first element (default 1)\n"
+        "  -f, --frames RANGE    render only FIRST:LAST frames (inclusive) of each message,\n"
+        "                        either bound may be omitted\n"
+        "  -t, --threads N       render up to N messages in parallel, output order is kept\n"
+        "      --stats           print throughput summary to standard error\n"
+        "  -h, --help            display this help and exit\n"
+        "\n"
+        "Lines that can't be rendered are reported and skipped, exit status is 1 then.\n");
+}
+
+int main(int argc, char *argv[]) {
+    Options opts = {1, 0, (unsigned)-1, 1, 0};
+    OutBuf out = {NULL, 0, 0, out_write, OUT_FLUSH, stdout, 0, 0};
+    unsigned long long n_messages = 0, n_frames = 0, n_skipped = 0, n_in = 0;
+    int n_files = 0, ok = 1;
+    double start;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            usage(stdout);
+            return 0;
+        } else if (!strcmp(arg, "--stats")) {
+            opts.stats = 1;
+        } else if (!strcmp(arg, "-s") || !strcmp(arg, "--spacing")) {
+            if (val == NULL || !parse_unsigned(val, &opts.spacing)) goto bad_arg;
+            i++;
+        } else if (!strcmp(arg, "-f") || !strcmp(arg, "--frames")) {
+            if (val == NULL || !parse_range(val, &opts.first, &opts.last)) goto bad_arg;
+            i++;
+        } else if (!strcmp(arg, "-t") || !strcmp(arg, "--threads")) {
+            if (val == NULL || !parse_unsigned(val, &opts.threads) || opts.threads == 0) goto bad_arg;
+            i++;
+        } else if (arg[0] == '-' && arg[1] != '\0') {
+            goto bad_arg;
+        } else {
+            /* file names are handled in the second pass */
+            n_files++;
+        }
+        continue;
+    bad_arg:
+        fprintf(stderr, "tguy: invalid option or argument '%s'\n", arg);
+        usage(stderr);
+        return 2;
+    }
+#ifndef TGUY_CLI_PTHREADS
+    if (opts.threads > 1) fprintf(stderr, "tguy: built without thread support, --threads is ignored\n");
+#endif
+
+    start = now_seconds();
+    if (n_files == 0) {
+        ok = process_file(stdin, "(standard input)", &opts, &out, &n_messages, &n_frames, &n_skipped, &n_in);
+    }
+    for (int i = 1; i < argc && ok; i++) {
+        const char *arg = argv[i];
+        FILE *fp;
+        if (!strcmp(arg, "-s") || !strcmp(arg, "--spacing") || !strcmp(arg, "-f") || !strcmp(arg, "--frames")
+            || !strcmp(arg, "-t") || !strcmp(arg, "--threads")) {
+            i++;
+            continue;
+        }
+        if (arg[0] == '-' && arg[1] != '\0') continue;
+        fp = strcmp(arg, "-") ? fopen(arg, "rb") : stdin;
+        if (fp == NULL) {
+            fprintf(stderr, "tguy: can't open '%s'\n", arg);
+            ok = 0;
+            break;
+        }
+        ok = process_file(fp, (fp == stdin) ? "(standard input)" : arg, &opts, &out,
+                          &n_messages, &n_frames, &n_skipped, &n_in);
+        if (fp != stdin) fclose(fp);
+    }
+    ok = out_flush(&out) && ok;
+    free(out.data);
+    if (fflush(stdout) != 0) {
+        if (!out.failed) fprintf(stderr, "tguy: write error: %s\n", strerror(errno));
+        ok = 0;
+    }
+
+    if (opts.stats) {
+        double elapsed = now_seconds() - start;
+        fprintf(stderr,
+            "messages: %llu\n"
+            "skipped:  %llu\n"
+            "frames:   %llu\n"
+            "input:    %llu bytes\n"
+            "output:   %llu bytes\n"
+            "time:     %.3f s\n"
+            "rate:     %.0f frames/s, %.1f MiB/s output\n",
+            n_messages, n_skipped, n_frames, n_in, out.written, elapsed,
+            elapsed > 0 ? (double)n_frames / elapsed : 0.0,
+            elapsed > 0 ? (double)out.written / elapsed / (1024.0 * 1024.0) : 0.0);
+    }
+    return (ok && n_skipped == 0) ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+#if !defined _WIN32 && !defined _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <libtguy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @file tguy_bench.c
+ *  Grapheme segmentation benchmark of the unicode backend libtguy was built with. \n
+ *  Prints constructor throughput of tguy_from_utf8(), which is dominated by segmentation but also includes
+ *  allocation and setting frame 0, along with the number of elements and a hash of their boundaries.
+ *  Without files, hash of the built-in sample is checked against a reference for extended grapheme clusters,
+ *  so backends diverging from them fail. Pass --expect HASH to check against another hash.
+ */
+
+#ifndef TGUY_BENCH_BACKEND
+#define TGUY_BENCH_BACKEND "unknown"
+#endif
+
+/**
+ * Boundaries hash of the no-file run for extended grapheme clusters (UAX #29). Not produced by a libtguy build:
+ * it was computed by hashing the lengths of Ruby's String#grapheme_clusters the same way boundaries_hash() does,
+ * which gives the same value with Unicode 12.1 to 15.0 tables. The same script over codepoints matches
+ * the "none" backend. Replace it with the output of a utf8proc build once one is checked
+ */
+#define SAMPLE_REFERENCE_HASH 0xc0ac4a1fced87765ull
+
+/** Text covering grapheme break rules, used when no files are given */
+static const char sample_text[] =
+    "The quick brown fox jumps over the lazy dog. "
+    "\xd0\x86\xd1\x83\xd0\xb2\xd1\x96\xd1\x83 \xd1\x97\xd0\xb6\xd0\xb0\xd0\xba " /* Ukrainian */
+    "e\xcc\x81 a\xcc\x8a\xcc\x81 " /* combining marks */
+    "\xed\x95\x9c\xea\xb8\x80 \xe1\x84\x92\xe1\x85\xa1\xe1\x86\xab " /* precomposed and conjoining Hangul */
+    "\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7\xe2\x80\x8d\xf0\x9f\x91\xa6 " /* ZWJ family */
+    "\xf0\x9f\x87\xba\xf0\x9f\x87\xa6\xf0\x9f\x87\xba\xf0\x9f\x87\xb8 " /* regional indicators */
+    "\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd " /* emoji modifier */
+    "\xe0\xa4\x95\xe0\xa4\xbf\xe0\xa4\xa4\xe0\xa4\xbe\xe0\xa4\xac " /* Devanagari vowel signs, no conjuncts whose rules differ between Unicode versions */
+    "\r\n\t";
+
+static double now_seconds(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+static char *read_file(const char *path, size_t *len) {
+    FILE *fp = fopen(path, "rb");
+    char *buf = NULL;
+    size_t cap = 0;
+    *len = 0;
+    if (fp == NULL) return NULL;
+    while (1) {
+        if (cap - *len < 65536) {
+            char *nbuf = realloc(buf, cap + 65536);
+            if (nbuf == NULL) break;
+            buf = nbuf;
+            cap += 65536;
+        }
+        size_t n = fread(&buf[*len], 1, cap - *len, fp);
+        *len += n;
+        if (n == 0) {
+            fclose(fp);
+            return buf;
+        }
+    }
+    free(buf);
+    fclose(fp);
+    return NULL;
+}
+
+/* FNV-1a over 8 little-endian bytes of element lengths,
+ * elements start right after TrashGuy sprite on the first frame with spacing 0 */
+static unsigned long long boundaries_hash(TrashGuyState *st, unsigned long long hash) {
+    size_t len;
+    const TGStrView *arr;
+    tguy_set_frame(st, 0);
+    arr = tguy_get_arr(st, &len);
+    for (size_t i = 2; i < len; i++) {
+        unsigned long long el = arr[i].len;
+        for (size_t j = 0; j < sizeof(el); j++, el >>= 8) {
+            hash ^= el & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+/**
+ *  Segments text repeatedly for at least min_seconds
+ * @return 0 on success, -1 if state couldn't be created
+ */
+static int bench_text(const char *name, const char *text, size_t len, double min_seconds,
+                      unsigned long long *hash) {
+    TrashGuyState *st = tguy_from_utf8(text, len, 0);
+    size_t n_elements;
+    unsigned long long runs = 0;
+    double start, elapsed;
+
+    if (st == NULL) {
+        fprintf(stderr, "tguy_bench: %s: failed to segment text\n", name);
+        return -1;
+    }
+    *hash = boundaries_hash(st, *hash);
+    tguy_get_arr(st, &n_elements);
+    n_elements -= 2;
+    tguy_free(st);
+
+    start = now_seconds();
+    do {
+        st = tguy_from_utf8(text, len, 0);
+        tguy_free(st);
+        runs++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < min_seconds);
+
+    printf("%-16s %-12s %12zu bytes %10zu elements %10.1f MiB/s (constructor)\n",
+           TGUY_BENCH_BACKEND, name, len, n_elements,
+           (double)len * (double)runs / elapsed / (1024.0 * 1024.0));
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long long hash = 14695981039346656037ull, expect = 0;
+    double min_seconds = 1.0;
+    int have_expect = 0, n_files = 0, ok = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--expect") && i + 1 < argc) {
+            expect = strtoull(argv[++i], NULL, 16);
+            have_expect = 1;
+        } else if (!strcmp(argv[i], "--time") && i + 1 < argc) {
+            min_seconds = strtod(argv[++i], NULL);
+        } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            printf("Usage: tguy_bench [--time SECONDS] [--expect HASH] [FILE]...\n"
+                   "Without FILEs built-in sample is checked against utf8proc boundaries unless --expect is given\n");
+            return 0;
+        }
+    }
+
+    for (int i = 1; i < argc && ok; i++) {
+        char *text;
+        size_t len;
+        if (!strcmp(argv[i], "--expect") || !strcmp(argv[i], "--time")) {
+            i++;
+            continue;
+        }
+        n_files++;
+        text = read_file(argv[i], &len);
+        if (text == NULL) {
+            fprintf(stderr, "tguy_bench: can't read '%s'\n", argv[i]);
+            return 2;
+        }
+        ok = bench_text(argv[i], text, len, min_seconds, &hash) == 0;
+        free(text);
+    }
+
+    if (n_files == 0) {
+        /* sample repeated to 1 MiB */
+        size_t sample_len = sizeof(sample_text) - 1, len = 0;
+        char *text = malloc((1u << 20) + sample_len);
+        if (text == NULL) return 2;
+        while (len < (1u << 20)) {
+            memcpy(&text[len], sample_text, sample_len);
+            len += sample_len;
+        }
+        ok = bench_text("sample", sample_text, sample_len, min_seconds / 2, &hash) == 0
+            && bench_text("sample-1MiB", text, len, min_seconds / 2, &hash) == 0;
+        free(text);
+        if (!have_expect) {
+            if (!strcmp(TGUY_BENCH_BACKEND, "none")) {
+                printf("reference check skipped, backend splits codepoints instead of grapheme clusters\n");
+            } else {
+                expect = SAMPLE_REFERENCE_HASH;
+                have_expect = 1;
+            }
+        }
+    }
+    if (!ok) return 2;
+
+    printf("boundaries hash: %016llx\n", hash);
+    if (have_expect && hash != expect) {
+        fprintf(stderr, "tguy_bench: boundaries differ from expected %016llx\n", expect);
+        return 1;
+    }
+    return 0;
+}